@@ -0,0 +1,190 @@
+#include "src/body.h"
+#include "src/collision_detection.h"
+#include "src/contact.h"
+#include "src/frame_arena.h"
+#include "src/shape.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+
+/**
+ * Pair dispatch through the constexpr table of CollisionDetection against
+ * the virtual get_type() chain it replaced
+ * The old chain is rebuilt here: every body gets a heap allocated object
+ * whose virtual get_type() is called six times per pair before branching
+ * to the same pair tests.
+ */
+
+namespace {
+
+struct LegacyType {
+    virtual ~LegacyType() = default;
+    virtual ShapeType get_type() const = 0;
+};
+
+template <ShapeType TYPE> struct LegacyTypeOf : LegacyType {
+    ShapeType get_type() const override { return TYPE; }
+};
+
+std::unique_ptr<LegacyType> make_legacy_type(ShapeType type) {
+    switch (type) {
+    case CIRCLE:
+        return std::make_unique<LegacyTypeOf<CIRCLE>>();
+    case POLYGON:
+        return std::make_unique<LegacyTypeOf<POLYGON>>();
+    default:
+        return std::make_unique<LegacyTypeOf<BOX>>();
+    }
+}
+
+using CollideFunction = CollisionDetection::CollideFunction;
+
+// the branches of the old is_colliding, boxes were tested as polygons
+CollideFunction legacy_dispatch(const LegacyType *a, const LegacyType *b) {
+    bool a_is_circle = a->get_type() == CIRCLE;
+    bool b_is_circle = b->get_type() == CIRCLE;
+    bool a_is_polygon = a->get_type() == POLYGON || a->get_type() == BOX;
+    bool b_is_polygon = b->get_type() == POLYGON || b->get_type() == BOX;
+
+    if (a_is_circle && b_is_circle) {
+        return CollisionDetection::is_colliding_circle_circle;
+    }
+    if (a_is_polygon && b_is_polygon) {
+        return CollisionDetection::is_colliding_polygon_polygon;
+    }
+    if (a_is_polygon && b_is_circle) {
+        return CollisionDetection::is_colliding_polygon_circle;
+    }
+    if (a_is_circle && b_is_polygon) {
+        return CollisionDetection::is_colliding_circle_polygon;
+    }
+    return nullptr;
+}
+
+struct Pair {
+    int a;
+    int b;
+};
+
+// best of several runs, in milliseconds
+template <typename F> double time_best(int runs, F &&run) {
+    double best = 1e30;
+    for (int i = 0; i < runs; i++) {
+        const auto start = std::chrono::steady_clock::now();
+        run();
+        const auto end = std::chrono::steady_clock::now();
+        const double ms =
+            std::chrono::duration<double, std::milli>(end - start).count();
+        best = ms < best ? ms : best;
+    }
+    return best;
+}
+
+} // namespace
+
+int main() {
+    // circles, boxes and triangles jumbled together, so the pair types
+    // change from one pair to the next and the branches can't be learnt
+    std::mt19937 random(11);
+    auto uniform = [&](float min, float max) {
+        return std::uniform_real_distribution<float>(min, max)(random);
+    };
+    const std::vector<Vec2> triangle = {Vec2(-15, 10), Vec2(15, 10),
+                                        Vec2(0, -15)};
+    std::vector<std::unique_ptr<Body>> bodies;
+    std::vector<std::unique_ptr<LegacyType>> legacy_types;
+    for (int i = 0; i < 4000; i++) {
+        const float x = uniform(0.0f, 2000.0f);
+        const float y = uniform(0.0f, 2000.0f);
+        const int kind = random() % 3;
+        if (kind == 0) {
+            bodies.push_back(std::make_unique<Body>(
+                CircleShape(uniform(5.0f, 20.0f)), x, y, 1.0f));
+        } else if (kind == 1) {
+            bodies.push_back(std::make_unique<Body>(
+                BoxShape(uniform(10.0f, 40.0f), uniform(10.0f, 40.0f)), x, y,
+                1.0f));
+        } else {
+            bodies.push_back(
+                std::make_unique<Body>(PolygonShape(triangle), x, y, 1.0f));
+        }
+        bodies.back()->rotation = uniform(0.0f, 6.28f);
+        bodies.back()->update_transform();
+        legacy_types.push_back(make_legacy_type(bodies.back()->shape->type));
+    }
+
+    // every pair whose bounds overlap, like the broad phase hands over
+    std::vector<Pair> pairs;
+    for (int i = 0; i < (int)bodies.size(); i++) {
+        for (int j = i + 1; j < (int)bodies.size(); j++) {
+            if (bodies[i]->shape->aabb.overlaps(bodies[j]->shape->aabb)) {
+                pairs.push_back({i, j});
+            }
+        }
+    }
+    std::shuffle(pairs.begin(), pairs.end(), random);
+
+    const int runs = 20;
+    const int repeats = 50;
+    std::printf("%zu bodies, %zu pairs, best of %d runs\n", bodies.size(),
+                pairs.size(), runs);
+
+    // the lookup alone, summing the function addresses keeps it alive
+    uintptr_t checksum = 0;
+    const double legacy_lookup = time_best(runs, [&] {
+        for (int r = 0; r < repeats; r++) {
+            for (const Pair &pair : pairs) {
+                checksum += (uintptr_t)legacy_dispatch(
+                    legacy_types[pair.a].get(), legacy_types[pair.b].get());
+            }
+        }
+    });
+    const double table_lookup = time_best(runs, [&] {
+        for (int r = 0; r < repeats; r++) {
+            for (const Pair &pair : pairs) {
+                checksum += (uintptr_t)CollisionDetection::dispatch(
+                    bodies[pair.a]->shape->type, bodies[pair.b]->shape->type);
+            }
+        }
+    });
+    std::printf("lookup x%d   virtual chain %8.3f ms   table %8.3f ms\n",
+                repeats, legacy_lookup, table_lookup);
+
+    // the full narrow phase, dispatch plus the pair test
+    std::vector<Contact> contacts;
+    FrameArena arena;
+    size_t num_contacts = 0;
+    const double legacy_collide = time_best(runs, [&] {
+        contacts.clear();
+        arena.reset();
+        for (const Pair &pair : pairs) {
+            Body *a = bodies[pair.a].get();
+            Body *b = bodies[pair.b].get();
+            if (!a->shape->aabb.overlaps(b->shape->aabb)) {
+                continue;
+            }
+            legacy_dispatch(legacy_types[pair.a].get(),
+                            legacy_types[pair.b].get())(a, b, contacts, arena,
+                                                        0.0f);
+        }
+        num_contacts = contacts.size();
+    });
+    const double table_collide = time_best(runs, [&] {
+        contacts.clear();
+        arena.reset();
+        for (const Pair &pair : pairs) {
+            CollisionDetection::is_colliding(bodies[pair.a].get(),
+                                             bodies[pair.b].get(), contacts,
+                                             arena);
+        }
+    });
+    std::printf("collide      virtual chain %8.3f ms   table %8.3f ms   "
+                "(%zu and %zu contacts)\n",
+                legacy_collide, table_collide, num_contacts, contacts.size());
+
+    return checksum == 0;
+}
@@ -0,0 +1,118 @@
+#include "src/aabb.h"
+#include "src/body.h"
+#include "src/shape.h"
+#include "src/shape_batch.h"
+#include "src/vec2.h"
+#include "src/vertex_transform.h"
+#include "src/world.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+/**
+ * Moving the vertices of 10k boxes to their bodies' poses, one polygon per
+ * transform_vertices() call against four per transform_polygons() call
+ * through ShapeBatch, single threaded. The bodies live in a World so
+ * their shapes are laid out as in a real step. The last column writes to
+ * one packed buffer instead of the shapes, to show what the stores into
+ * each shape's own vertices cost.
+ */
+
+namespace {
+
+// best of several runs, in milliseconds
+template <typename F> double time_best(int runs, F &&run) {
+    double best = 1e30;
+    for (int i = 0; i < runs; i++) {
+        const auto start = std::chrono::steady_clock::now();
+        run();
+        const auto end = std::chrono::steady_clock::now();
+        const double ms =
+            std::chrono::duration<double, std::milli>(end - start).count();
+        best = ms < best ? ms : best;
+    }
+    return best;
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 random(5);
+    auto uniform = [&](float min, float max) {
+        return std::uniform_real_distribution<float>(min, max)(random);
+    };
+    World world(0.0f);
+    std::vector<Body *> bodies;
+    for (int i = 0; i < 10000; i++) {
+        Body *body = world.get_body(world.create_body(
+            BoxShape(uniform(10.0f, 40.0f), uniform(10.0f, 40.0f)),
+            (i % 100) * 50.0f, (i / 100) * 50.0f, 1.0f));
+        body->rotation = uniform(0.0f, 6.28f);
+        body->update_rotation();
+        bodies.push_back(body);
+    }
+    ShapeBatch batch;
+    batch.build(bodies);
+
+    // the same local vertices and poses, results into one buffer
+    const int num_blocks = batch.get_num_blocks();
+    std::vector<float> local_x(16 * num_blocks);
+    std::vector<float> local_y(16 * num_blocks);
+    std::vector<float> cos_angle(4 * num_blocks);
+    std::vector<float> sin_angle(4 * num_blocks);
+    std::vector<Vec2> position(4 * num_blocks);
+    for (int i = 0; i < (int)bodies.size(); i++) {
+        const int block = i / 4;
+        const int lane = i % 4;
+        const PolygonShape *box = (PolygonShape *)bodies[i]->shape;
+        for (int k = 0; k < 4; k++) {
+            local_x[16 * block + 4 * k + lane] = box->local_vertices[k].x;
+            local_y[16 * block + 4 * k + lane] = box->local_vertices[k].y;
+        }
+        cos_angle[i] = bodies[i]->cos_rotation;
+        sin_angle[i] = bodies[i]->sin_rotation;
+        position[i] = bodies[i]->position;
+    }
+    std::vector<Vec2> packed(16 * num_blocks);
+    std::vector<AABB> packed_bounds(4 * num_blocks);
+
+    const int runs = 20;
+    const int frames = 100;
+    std::printf("%zu boxes, %d frames, best of %d runs\n", bodies.size(),
+                frames, runs);
+
+    const double per_polygon = time_best(runs, [&] {
+        for (int f = 0; f < frames; f++) {
+            for (auto body : bodies) {
+                body->shape->update_vertices(
+                    body->cos_rotation, body->sin_rotation, body->position);
+            }
+        }
+    });
+    const double batched = time_best(runs, [&] {
+        for (int f = 0; f < frames; f++) {
+            batch.update_polygons(0, num_blocks);
+        }
+    });
+    const double packed_only = time_best(runs, [&] {
+        for (int f = 0; f < frames; f++) {
+            for (int b = 0; b < num_blocks; b++) {
+                Vec2 *world_of[4];
+                AABB *bounds_of[4];
+                for (int l = 0; l < 4; l++) {
+                    world_of[l] = &packed[16 * b + 4 * l];
+                    bounds_of[l] = &packed_bounds[4 * b + l];
+                }
+                transform_polygons(&local_x[16 * b], &local_y[16 * b], 4,
+                                   &cos_angle[4 * b], &sin_angle[4 * b],
+                                   &position[4 * b], world_of, bounds_of);
+            }
+        }
+    });
+    std::printf("per polygon %8.3f ms   batched %8.3f ms   "
+                "packed output %8.3f ms\n",
+                per_polygon, batched, packed_only);
+
+    return packed_bounds[0].min.x == packed_bounds[0].max.x;
+}
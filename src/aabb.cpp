@@ -0,0 +1,26 @@
+#include "aabb.h"
+#include "vec2.h"
+#include <algorithm>
+
+AABB::AABB() : min(Vec2(0, 0)), max(Vec2(0, 0)) {}
+AABB::AABB(const Vec2 &min, const Vec2 &max) : min(min), max(max) {}
+
+// touching boxes count as overlapping, same as the narrow phase
+bool AABB::overlaps(const AABB &other) const {
+    return min.x <= other.max.x && other.min.x <= max.x &&
+           min.y <= other.max.y && other.min.y <= max.y;
+}
+
+bool AABB::contains(const AABB &other) const {
+    return min.x <= other.min.x && min.y <= other.min.y &&
+           other.max.x <= max.x && other.max.y <= max.y;
+}
+
+float AABB::perimeter() const {
+    return 2.0f * ((max.x - min.x) + (max.y - min.y));
+}
+
+AABB AABB::combine(const AABB &a, const AABB &b) {
+    return AABB(Vec2(std::min(a.min.x, b.min.x), std::min(a.min.y, b.min.y)),
+                Vec2(std::max(a.max.x, b.max.x), std::max(a.max.y, b.max.y)));
+}
@@ -0,0 +1,24 @@
+#ifndef AABB_H
+#define AABB_H
+
+#include "vec2.h"
+
+/**
+ * Axis-aligned bounding box in world space
+ */
+struct AABB {
+    Vec2 min;
+    Vec2 max;
+
+    AABB();
+    AABB(const Vec2 &min, const Vec2 &max);
+
+    bool overlaps(const AABB &other) const;
+    bool contains(const AABB &other) const;
+    float perimeter() const;
+
+    // smallest AABB enclosing both boxes
+    static AABB combine(const AABB &a, const AABB &b);
+};
+
+#endif
@@ -2,6 +2,7 @@
 #include "body.h"
 #include "constants.h"
 #include "constraint.h"
+#include "contact.h"
 #include "graphics.h"
 #include "shape.h"
 #include "vec2.h"
@@ -25,6 +26,12 @@ void AppConstraint::setup() {
     running = Graphics::open_window();
 
     world = new World(-9.8);
+    world->set_debug_draw_contact([](const Contact &contact) {
+        Graphics::draw_circle(contact.start.x, contact.start.y, 5, 0.0,
+                              0xFF00FFFF);
+        Graphics::draw_circle(contact.end.x, contact.end.y, 2, 0.0,
+                              0xFF00FFFF);
+    });
 
     SDL_Surface *bg_surface = IMG_Load("./assets/angrybirds/background.png");
     if (bg_surface) {
@@ -34,58 +41,60 @@ void AppConstraint::setup() {
     }
 
     // add bird
-    Body *bird =
-        new Body(CircleShape(45), 100, Graphics::height() / 2.0 + 220, 3.0);
-    bird->set_texture("./assets/angrybirds/bird-red.png");
-    world->add_body(bird);
+    Body *bird = world->get_body(world->create_body(
+        CircleShape(45), 100, Graphics::height() / 2.0 + 220, 3.0));
+    bird->texture = Graphics::load_texture("./assets/angrybirds/bird-red.png");
+    // launched hard enough to pass through the fences between two steps
+    bird->is_bullet = true;
 
-    Body *floor =
-        new Body(BoxShape(Graphics::width() - 50, 50), Graphics::width() / 2.0,
-                 Graphics::height() / 2.0 + 350, 0.0);
+    Body *floor = world->get_body(world->create_body(
+        BoxShape(Graphics::width() - 50, 50), Graphics::width() / 2.0,
+        Graphics::height() / 2.0 + 350, 0.0));
     floor->restitution = 0.1;
-    Body *left_fence = new Body(BoxShape(50, Graphics::height() - 200), 0,
-                                Graphics::height() / 2.0 - 35, 0.0);
-    Body *right_fence =
-        new Body(BoxShape(50, Graphics::height() - 200), Graphics::width(),
-                 Graphics::height() / 2.0 - 35, 0.0);
-    world->add_body(floor);
-    world->add_body(left_fence);
-    world->add_body(right_fence);
+    // left and right fence
+    world->create_body(BoxShape(50, Graphics::height() - 200), 0,
+                       Graphics::height() / 2.0 - 35, 0.0);
+    world->create_body(BoxShape(50, Graphics::height() - 200),
+                       Graphics::width(), Graphics::height() / 2.0 - 35, 0.0);
 
     // add stack of boxes
     for (int i = 1; i <= 4; i++) {
         float mass = 10.0 / (float)i;
-        Body *box = new Body(BoxShape(50, 50), Graphics::width() / 2.0 - 300,
-                             floor->position.y - i * 55, mass);
-        box->set_texture("./assets/angrybirds/wood-box.png");
+        Body *box = world->get_body(world->create_body(
+            BoxShape(50, 50), Graphics::width() / 2.0 - 300,
+            floor->position.y - i * 55, mass));
+        box->texture =
+            Graphics::load_texture("./assets/angrybirds/wood-box.png");
         box->friction = 0.9;
         box->restitution = 0.1;
-        world->add_body(box);
     }
 
     // add structure with blocks
-    Body *plank1 = new Body(BoxShape(50, 150), Graphics::width() / 2.0 + 20,
-                            floor->position.y - 100, 5.0);
-    Body *plank2 = new Body(BoxShape(50, 150), Graphics::width() / 2.0 + 180,
-                            floor->position.y - 100, 5.0);
-    Body *plank3 = new Body(BoxShape(250, 25), Graphics::width() / 2.0 + 100.0f,
-                            floor->position.y - 200, 2.0);
+    Body *plank1 = world->get_body(world->create_body(
+        BoxShape(50, 150), Graphics::width() / 2.0 + 20,
+        floor->position.y - 100, 5.0));
+    Body *plank2 = world->get_body(world->create_body(
+        BoxShape(50, 150), Graphics::width() / 2.0 + 180,
+        floor->position.y - 100, 5.0));
+    Body *plank3 = world->get_body(world->create_body(
+        BoxShape(250, 25), Graphics::width() / 2.0 + 100.0f,
+        floor->position.y - 200, 2.0));
     // plank3->restitution = 0.1;
-    plank1->set_texture("./assets/angrybirds/wood-plank-solid.png");
-    plank2->set_texture("./assets/angrybirds/wood-plank-solid.png");
-    plank3->set_texture("./assets/angrybirds/wood-plank-cracked.png");
-
-    world->add_body(plank1);
-    world->add_body(plank2);
-    world->add_body(plank3);
+    plank1->texture =
+        Graphics::load_texture("./assets/angrybirds/wood-plank-solid.png");
+    plank2->texture =
+        Graphics::load_texture("./assets/angrybirds/wood-plank-solid.png");
+    plank3->texture =
+        Graphics::load_texture("./assets/angrybirds/wood-plank-cracked.png");
 
     // add triangle polygon
     std::vector<Vec2> triangle_vertices = {Vec2(30, 30), Vec2(-30, 30),
                                            Vec2(0, -30)};
-    Body *triangle = new Body(PolygonShape(triangle_vertices),
-                              plank3->position.x, plank3->position.y - 50, 0.5);
-    triangle->set_texture("./assets/angrybirds/wood-triangle.png");
-    world->add_body(triangle);
+    Body *triangle = world->get_body(world->create_body(
+        PolygonShape(triangle_vertices), plank3->position.x,
+        plank3->position.y - 50, 0.5));
+    triangle->texture =
+        Graphics::load_texture("./assets/angrybirds/wood-triangle.png");
 
     // add pyramid of boxes
     int num_rows = 5;
@@ -95,55 +104,57 @@ void AppConstraint::setup() {
                 (plank3->position.x + 200.0f) + col * 50.0f - (row * 25.0f);
             float y = (floor->position.y - 50.0f) - row * 52.0f;
             float mass = (5.0f / (row + 1.0f));
-            Body *box = new Body(BoxShape(50, 50), x, y, mass);
+            Body *box = world->get_body(world->create_body(
+                BoxShape(50, 50), x, y, mass));
             box->friction = 0.9;
             box->restitution = 0.0;
-            box->set_texture("./assets/angrybirds/wood-box.png");
-            world->add_body(box);
+            box->texture =
+                Graphics::load_texture("./assets/angrybirds/wood-box.png");
         }
     }
 
     // add a bridge of connected steps and joints
     int num_steps = 10;
     int spacing = 33;
-    Body *start_step = new Body(BoxShape(80, 20), 200, 200, 0.0);
-    start_step->set_texture("./assets/angrybirds/rock-bridge-anchor.png");
-    world->add_body(start_step);
+    Body *start_step = world->get_body(world->create_body(
+        BoxShape(80, 20), 200, 200, 0.0));
+    start_step->texture =
+        Graphics::load_texture("./assets/angrybirds/rock-bridge-anchor.png");
     Body *last = floor;
     for (int i = 1; i <= num_steps; i++) {
         float x = start_step->position.x + 30 + (i * spacing);
         float y = start_step->position.y + 20;
         float mass = (i == num_steps) ? 0.0 : 3.0;
-        Body *step = new Body(CircleShape(15), x, y, mass);
-        step->set_texture("./assets/angrybirds/wood-bridge-step.png");
-        world->add_body(step);
+        Body *step = world->get_body(world->create_body(
+            CircleShape(15), x, y, mass));
+        step->texture =
+            Graphics::load_texture("./assets/angrybirds/wood-bridge-step.png");
         JointConstraint *joint =
             new JointConstraint(last, step, step->position);
         world->add_constraint(joint);
         last = step;
     }
 
-    Body *end_step = new Body(BoxShape(80, 20), last->position.x + 60,
-                              last->position.y - 20, 0.0);
-    end_step->set_texture("./assets/angrybirds/rock-bridge-anchor.png");
-    world->add_body(end_step);
+    Body *end_step = world->get_body(world->create_body(
+        BoxShape(80, 20), last->position.x + 60, last->position.y - 20, 0.0));
+    end_step->texture =
+        Graphics::load_texture("./assets/angrybirds/rock-bridge-anchor.png");
 
     // add pigs
-    Body *pig1 = new Body(CircleShape(30), plank1->position.x + 80,
-                          floor->position.y - 50, 3.0);
-    Body *pig2 = new Body(CircleShape(30), plank2->position.x + 400,
-                          floor->position.y - 50, 3.0);
-    Body *pig3 = new Body(CircleShape(30), plank2->position.x + 460,
-                          floor->position.y - 50, 3.0);
-    Body *pig4 = new Body(CircleShape(30), 220, 130, 1.0);
-    pig1->set_texture("./assets/angrybirds/pig-1.png");
-    pig2->set_texture("./assets/angrybirds/pig-2.png");
-    pig3->set_texture("./assets/angrybirds/pig-1.png");
-    pig4->set_texture("./assets/angrybirds/pig-2.png");
-    world->add_body(pig1);
-    world->add_body(pig2);
-    world->add_body(pig3);
-    world->add_body(pig4);
+    Body *pig1 = world->get_body(world->create_body(
+        CircleShape(30), plank1->position.x + 80, floor->position.y - 50, 3.0));
+    Body *pig2 = world->get_body(world->create_body(
+        CircleShape(30), plank2->position.x + 400, floor->position.y - 50,
+        3.0));
+    Body *pig3 = world->get_body(world->create_body(
+        CircleShape(30), plank2->position.x + 460, floor->position.y - 50,
+        3.0));
+    Body *pig4 = world->get_body(world->create_body(
+        CircleShape(30), 220, 130, 1.0));
+    pig1->texture = Graphics::load_texture("./assets/angrybirds/pig-1.png");
+    pig2->texture = Graphics::load_texture("./assets/angrybirds/pig-2.png");
+    pig3->texture = Graphics::load_texture("./assets/angrybirds/pig-1.png");
+    pig4->texture = Graphics::load_texture("./assets/angrybirds/pig-2.png");
 }
 
 /**
@@ -191,19 +202,21 @@ void AppConstraint::input() {
             if (event.button.button == SDL_BUTTON_LEFT) {
                 int x, y;
                 SDL_GetMouseState(&x, &y);
-                Body *rock = new Body(CircleShape(30), x, y, 1.0);
-                rock->set_texture("./assets/angrybirds/rock-round.png");
+                Body *rock = world->get_body(world->create_body(
+                    CircleShape(30), x, y, 1.0));
+                rock->texture = Graphics::load_texture(
+                    "./assets/angrybirds/rock-round.png");
                 rock->friction = 0.4;
-                world->add_body(rock);
             }
             if (event.button.button == SDL_BUTTON_RIGHT) {
                 int x, y;
                 SDL_GetMouseState(&x, &y);
-                Body *box = new Body(BoxShape(60, 60), x, y, 1.0);
-                box->set_texture("./assets/angrybirds/rock-box.png");
+                Body *box = world->get_body(world->create_body(
+                    BoxShape(60, 60), x, y, 1.0));
+                box->texture =
+                    Graphics::load_texture("./assets/angrybirds/rock-box.png");
                 box->angular_vel = 0.0;
                 box->friction = 0.9;
-                world->add_body(box);
             }
             break;
         }
@@ -234,18 +247,12 @@ void AppConstraint::update() {
     // **frame rate independent movement**
     //  (current time in ms of this frame - time in ms of previous frame)
     float delta_time = (SDL_GetTicks() - time_previous_frame) / 1000.0f;
-    // protect delta_time from consuming large values that could potentially
-    // mess up the execution
-    // e.g. when debugging
-    if (delta_time > 0.016) {
-        delta_time = 0.016;
-    }
 
     time_previous_frame = SDL_GetTicks();
 
-    // how many pixels to move _per second_
-
-    world->update(delta_time);
+    // the world runs as many fixed steps as fit in delta_time and caps them
+    // itself, so large values (e.g. when debugging) are safe
+    world->step(delta_time);
 }
 
 /**
@@ -265,33 +272,36 @@ void AppConstraint::render() {
     // Graphics::draw_line(pa.x, pa.y, pb.x, pb.y, 0xFF555555);
     // }
 
+    // draw bodies between the last two fixed steps
+    const float alpha = world->get_alpha();
     for (auto body : world->get_bodies()) {
         // Uint32 color = body->is_colliding ? 0xFF0000FF : 0xFFFFFFFF;
         Uint32 color = 0xFF0000FF;
+        const Vec2 position = body->get_interpolated_position(alpha);
+        const float rotation = body->get_interpolated_rotation(alpha);
         if (body->shape->get_type() == CIRCLE) {
             CircleShape *circle_shape = (CircleShape *)body->shape;
             // Graphics::draw_fill_circle(body->position.x, body->position.y,
             // circle_shape->radius, color);
 
             if (!debug && body->texture) {
-                Graphics::draw_texture(body->position.x, body->position.y,
+                Graphics::draw_texture(position.x, position.y,
                                        circle_shape->radius * 2,
-                                       circle_shape->radius * 2, body->rotation,
+                                       circle_shape->radius * 2, rotation,
                                        body->texture);
             } else if (debug) {
-                Graphics::draw_circle(body->position.x, body->position.y,
-                                      circle_shape->radius, body->rotation,
-                                      color);
+                Graphics::draw_circle(position.x, position.y,
+                                      circle_shape->radius, rotation, color);
             }
         }
         if (body->shape->get_type() == BOX) {
             BoxShape *box_shape = (BoxShape *)body->shape;
             if (!debug && body->texture) {
-                Graphics::draw_texture(body->position.x, body->position.y,
-                                       box_shape->width, box_shape->height,
-                                       body->rotation, body->texture);
+                Graphics::draw_texture(position.x, position.y, box_shape->width,
+                                       box_shape->height, rotation,
+                                       body->texture);
             } else if (debug) {
-                Graphics::draw_polygon(body->position.x, body->position.y,
+                Graphics::draw_polygon(position.x, position.y,
                                        box_shape->world_vertices, color);
             }
         }
@@ -299,10 +309,10 @@ void AppConstraint::render() {
             PolygonShape *polygon_shape = (PolygonShape *)body->shape;
             if (!debug && body->texture) {
                 Graphics::draw_texture(
-                    body->position.x, body->position.y, polygon_shape->width,
-                    polygon_shape->height, body->rotation, body->texture);
+                    position.x, position.y, polygon_shape->width,
+                    polygon_shape->height, rotation, body->texture);
             } else if (debug) {
-                Graphics::draw_polygon(body->position.x, body->position.y,
+                Graphics::draw_polygon(position.x, position.y,
                                        polygon_shape->world_vertices, color);
             }
         }
@@ -1,12 +1,12 @@
 #include "app_rigid_body.h"
 #include "body.h"
-#include "collision_detection.h"
 #include "constants.h"
 #include "contact.h"
 #include "force.h"
 #include "graphics.h"
 #include "shape.h"
 #include "vec2.h"
+#include "world.h"
 #include <SDL2/SDL_events.h>
 #include <SDL2/SDL_keycode.h>
 #include <SDL2/SDL_mouse.h>
@@ -45,32 +45,48 @@ void AppRigidBody::setup() {
     box_b->angular_vel = 0.1;
     */
 
-    Body *floor =
-        new Body(BoxShape(Graphics::width() - 100, 50), Graphics::width() / 2.0,
-                 Graphics::height() - 25, 0.0);
+    world = new World(-9.8);
+    // contact points and normals, drawn while debugging
+    world->set_debug_draw_contact([this](const Contact &contact) {
+        if (!debug) {
+            return;
+        }
+        Graphics::draw_fill_circle(contact.start.x, contact.start.y, 3,
+                                   0xFFFF00FF);
+        Graphics::draw_fill_circle(contact.end.x, contact.end.y, 3,
+                                   0xFFFF00FF);
+        // only draw 15px of the line between two contact points
+        Graphics::draw_line(contact.start.x, contact.start.y,
+                            contact.normal.x * 15 + contact.start.x,
+                            contact.normal.y * 15 + contact.start.y,
+                            0xFFFF00FF);
+    });
+
+    Body *floor = world->get_body(world->create_body(
+        BoxShape(Graphics::width() - 100, 50), Graphics::width() / 2.0,
+        Graphics::height() - 25, 0.0));
     floor->restitution = 0.5;
-    Body *left_wall = new Body(BoxShape(50, Graphics::height()), 25,
-                               Graphics::height() / 2.0, 0.0);
+    Body *left_wall = world->get_body(world->create_body(
+        BoxShape(50, Graphics::height()), 25, Graphics::height() / 2.0, 0.0));
     left_wall->restitution = 0.2;
-    Body *right_wall =
-        new Body(BoxShape(50, Graphics::height()), Graphics::width() - 25,
-                 Graphics::height() / 2.0, 0.0);
+    Body *right_wall = world->get_body(
+        world->create_body(BoxShape(50, Graphics::height()),
+                           Graphics::width() - 25, Graphics::height() / 2.0,
+                           0.0));
     right_wall->restitution = 0.2;
-    bodies.push_back(floor);
-    bodies.push_back(left_wall);
-    bodies.push_back(right_wall);
 
-    Body *big_box = new Body(BoxShape(200, 200), Graphics::width() / 2.0,
-                             Graphics::height() / 2.0, 0.0);
+    Body *big_box = world->get_body(
+        world->create_body(BoxShape(200, 200), Graphics::width() / 2.0,
+                           Graphics::height() / 2.0, 0.0));
     big_box->restitution = 0.7;
     big_box->rotation = 1.4;
-    big_box->set_texture("./assets/crate.png");
+    big_box->update_transform();
+    big_box->texture = Graphics::load_texture("./assets/crate.png");
 
-    // Body *ball = new Body(CircleShape(50), Graphics::width() / 2.0,
-    // Graphics::height() / 2.0, 1.0);
+    // Body *ball = world->get_body(world->create_body(
+    //     CircleShape(50), Graphics::width() / 2.0, Graphics::height() / 2.0,
+    //     1.0));
     // ball->restitution = 0.1;
-
-    bodies.push_back(big_box);
 }
 
 /**
@@ -185,18 +201,19 @@ void AppRigidBody::input() {
             if (event.button.button == SDL_BUTTON_LEFT) {
                 int x, y;
                 SDL_GetMouseState(&x, &y);
-                Body *ball = new Body(CircleShape(30), x, y, 1.0);
-                ball->set_texture("./assets/basketball.png");
+                Body *ball = world->get_body(
+                    world->create_body(CircleShape(30), x, y, 1.0));
+                ball->texture =
+                    Graphics::load_texture("./assets/basketball.png");
                 ball->restitution = 0.5;
-                bodies.push_back(ball);
             }
             if (event.button.button == SDL_BUTTON_RIGHT) {
                 int x, y;
                 SDL_GetMouseState(&x, &y);
-                Body *box = new Body(BoxShape(60, 60), x, y, 1.0);
-                box->set_texture("./assets/crate.png");
+                Body *box = world->get_body(
+                    world->create_body(BoxShape(60, 60), x, y, 1.0));
+                box->texture = Graphics::load_texture("./assets/crate.png");
                 box->restitution = 0.2;
-                bodies.push_back(box);
             }
             break;
         }
@@ -246,61 +263,14 @@ void AppRigidBody::update() {
     bodies[1]->apply_force(-g_force);
     */
 
+    // the body added last is pushed with the arrow keys
+    std::vector<Body *> &bodies = world->get_bodies();
     if (bodies.size() > 0) {
         bodies[bodies.size() - 1]->apply_force(push_force);
     }
 
-    for (auto body : bodies) {
-        Vec2 weight = Vec2(0.0, body->mass * 9.8 * PIXELS_PER_METER);
-        body->apply_force(weight);
-
-        // Torque
-        // float torque = 200;
-        // body->apply_torque(torque);
-
-        // wind
-        // Vec2 wind = Vec2(2.0 * PIXELS_PER_METER, 0.0);
-        // body->apply_force(wind);
-    }
-
-    for (auto body : bodies) {
-        body->update(delta_time);
-    }
-
-    for (auto body : bodies) {
-        body->is_colliding = false;
-    }
-
-    // Collision detection
-    // check all rigidbodies with other rigidbodies
-    for (size_t i = 0; i <= bodies.size() - 1; i++) {
-        for (size_t j = i + 1; j < bodies.size(); j++) {
-            Body *a = bodies[i];
-            Body *b = bodies[j];
-
-            Contact contact;
-
-            // check bodies[i] with bodies[j]
-            if (CollisionDetection::is_colliding(a, b, contact)) {
-                contact.resolve_collision();
-
-                if (debug) {
-                    Graphics::draw_fill_circle(contact.start.x, contact.start.y,
-                                               3, 0xFFFF00FF);
-                    Graphics::draw_fill_circle(contact.end.x, contact.end.y, 3,
-                                               0xFFFF00FF);
-                    // only draw 15px of the line between two contact points
-                    Graphics::draw_line(contact.start.x, contact.start.y,
-                                        contact.normal.x * 15 + contact.start.x,
-                                        contact.normal.y * 15 + contact.start.y,
-                                        0xFFFF00FF);
-                    // collision!
-                    a->is_colliding = true;
-                    b->is_colliding = true;
-                }
-            }
-        }
-    }
+    // weight, collisions and integration all happen in the world
+    world->update(delta_time);
 
     /*
      * Check for boundaries
@@ -341,8 +311,8 @@ void AppRigidBody::render() {
     // `FF` - full opacity, no transparency
     // Graphics::clear_screen(0xFF056263);
 
-    for (auto body : bodies) {
-        Uint32 color = body->is_colliding ? 0xFF0000FF : 0xFFFFFFFF;
+    for (auto body : world->get_bodies()) {
+        Uint32 color = 0xFFFFFFFF;
         if (body->shape->get_type() == CIRCLE) {
             CircleShape *circle_shape = (CircleShape *)body->shape;
             // Graphics::draw_fill_circle(body->position.x, body->position.y,
@@ -390,8 +360,7 @@ void AppRigidBody::render() {
  * Destroy function to delete objects and close the window
  */
 void AppRigidBody::destroy() {
-    for (auto body : bodies) {
-        delete body;
-    }
+    // the world owns the bodies
+    delete world;
     Graphics::close_window();
 }
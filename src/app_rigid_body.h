@@ -4,6 +4,7 @@
 #include "body.h"
 #include "graphics.h"
 #include "vec2.h"
+#include "world.h"
 #include <SDL2/SDL_rect.h>
 #include <vector>
 
@@ -11,7 +12,7 @@ class AppRigidBody {
   private:
     bool debug = false;
     bool running = false;
-    std::vector<Body *> bodies;
+    World *world;
 
     Vec2 push_force = Vec2(0, 0); // controlled by keyboard
     Vec2 mouse_cursor = Vec2(0, 0);
@@ -21,28 +21,26 @@ void AppWorld::setup() {
 
     world = new World(-9.8);
 
-    Body *floor =
-        new Body(BoxShape(Graphics::width() - 100, 50), Graphics::width() / 2.0,
-                 Graphics::height() - 25, 0.0);
+    Body *floor = world->get_body(world->create_body(
+        BoxShape(Graphics::width() - 100, 50), Graphics::width() / 2.0,
+        Graphics::height() - 25, 0.0));
     floor->restitution = 0.5;
-    Body *left_wall = new Body(BoxShape(50, Graphics::height()), 25,
-                               Graphics::height() / 2.0, 0.0);
+    Body *left_wall = world->get_body(world->create_body(
+        BoxShape(50, Graphics::height()), 25, Graphics::height() / 2.0, 0.0));
     left_wall->restitution = 0.2;
-    Body *right_wall =
-        new Body(BoxShape(50, Graphics::height()), Graphics::width() - 25,
-                 Graphics::height() / 2.0, 0.0);
+    Body *right_wall = world->get_body(
+        world->create_body(BoxShape(50, Graphics::height()),
+                           Graphics::width() - 25, Graphics::height() / 2.0,
+                           0.0));
     right_wall->restitution = 0.2;
-    world->add_body(floor);
-    world->add_body(left_wall);
-    world->add_body(right_wall);
 
-    Body *big_box = new Body(BoxShape(200, 200), Graphics::width() / 2.0,
-                             Graphics::height() / 2.0, 0.0);
+    Body *big_box = world->get_body(
+        world->create_body(BoxShape(200, 200), Graphics::width() / 2.0,
+                           Graphics::height() / 2.0, 0.0));
     big_box->restitution = 0.7;
     big_box->rotation = 1.4;
-    big_box->set_texture("./assets/crate.png");
-
-    world->add_body(big_box);
+    big_box->update_transform();
+    big_box->texture = Graphics::load_texture("./assets/crate.png");
 }
 
 /**
@@ -157,18 +155,19 @@ void AppWorld::input() {
             if (event.button.button == SDL_BUTTON_LEFT) {
                 int x, y;
                 SDL_GetMouseState(&x, &y);
-                Body *ball = new Body(CircleShape(30), x, y, 1.0);
-                ball->set_texture("./assets/basketball.png");
+                Body *ball = world->get_body(
+                    world->create_body(CircleShape(30), x, y, 1.0));
+                ball->texture =
+                    Graphics::load_texture("./assets/basketball.png");
                 ball->restitution = 0.5;
-                world->add_body(ball);
             }
             if (event.button.button == SDL_BUTTON_RIGHT) {
                 int x, y;
                 SDL_GetMouseState(&x, &y);
-                Body *box = new Body(BoxShape(60, 60), x, y, 1.0);
-                box->set_texture("./assets/crate.png");
+                Body *box = world->get_body(
+                    world->create_body(BoxShape(60, 60), x, y, 1.0));
+                box->texture = Graphics::load_texture("./assets/crate.png");
                 box->restitution = 0.2;
-                world->add_body(box);
             }
             break;
         }
@@ -221,7 +220,7 @@ void AppWorld::render() {
     // Graphics::clear_screen(0xFF056263);
 
     for (auto body : world->get_bodies()) {
-        Uint32 color = body->is_colliding ? 0xFF0000FF : 0xFFFFFFFF;
+        Uint32 color = 0xFFFFFFFF;
         if (body->shape->get_type() == CIRCLE) {
             CircleShape *circle_shape = (CircleShape *)body->shape;
             // Graphics::draw_fill_circle(body->position.x, body->position.y,
@@ -1,10 +1,6 @@
 #include "body.h"
-#include "graphics.h"
 #include "shape.h"
 #include "vec2.h"
-#include <SDL2/SDL_image.h>
-#include <SDL2/SDL_render.h>
-#include <SDL2/SDL_surface.h>
 #include <cmath>
 #include <iostream>
 #include <math.h>
@@ -12,23 +8,32 @@
 // Remember to initialize the member variables in the _same_ order that they are
 // declared. Otherwise you will get those `-Werror=reorder` compile errors
 Body::Body(const Shape &shape, float x, float y, float mass)
+    : Body(shape.clone(), x, y, mass) {
+    owns_shape = true;
+}
+
+Body::Body(Shape *shape, float x, float y, float mass)
     : position(Vec2(x, y)), velocity(Vec2(0, 0)), acceleartion(Vec2(0, 0)),
-      rotation(0.0), angular_vel(0.0), angular_acc(0.0), sum_forces(Vec2(0, 0)),
+      prev_position(Vec2(x, y)), rotation(0.0), angular_vel(0.0),
+      angular_acc(0.0), prev_rotation(0.0), sum_forces(Vec2(0, 0)),
       sum_torque(0.0), mass(mass), restitution(0.6), friction(0.7),
-      shape(shape.clone()) {
+      shape(shape) {
     inv_mass = mass != 0.0 ? (1.0 / mass) : 0.0;
 
     I = this->shape->get_moment_of_inertia() * mass;
     inv_I = I != 0.0 ? (1.0 / I) : 0.0;
 
-    this->shape->update_vertices(rotation, position);
+    is_awake = !is_static();
+
+    update_transform();
 
     std::cout << "Body constructor called!" << std::endl;
 }
 
 Body::~Body() {
-    delete shape;
-    SDL_DestroyTexture(texture);
+    if (owns_shape) {
+        delete shape;
+    }
     std::cout << "Body destructor called!" << std::endl;
 }
 
@@ -70,7 +75,7 @@ void Body::update(float dt) {
     integrate_linear(dt);
     integrate_angular(dt);
 
-    shape->update_vertices(rotation, position);
+    update_transform();
 
     /*
     bool is_polygon = shape->get_type() == POLYGON || shape->get_type() == BOX;
@@ -81,20 +86,35 @@ void Body::update(float dt) {
     */
 }
 
-void Body::set_texture(const char *texture_file_name) {
-    SDL_Surface *surface = IMG_Load(texture_file_name);
-    if (surface) {
-        texture = SDL_CreateTextureFromSurface(Graphics::renderer, surface);
-        SDL_FreeSurface(surface);
-    }
-}
-
 bool Body::is_static() const {
     // PAY ATTENTION when comparing floating points!
     const float epsilon = 0.005f;
     return fabs(inv_mass - 0.0) < epsilon;
 }
 
+void Body::set_awake(bool awake) {
+    if (is_static()) {
+        return;
+    }
+
+    if (awake) {
+        if (!is_awake) {
+            is_awake = true;
+            sleep_time = 0.0f;
+        }
+        return;
+    }
+
+    is_awake = false;
+    sleep_time = 0.0f;
+    // rest exactly where the body stopped
+    save_pose();
+    velocity = Vec2(0.0, 0.0);
+    angular_vel = 0.0;
+    clear_forces();
+    clear_torque();
+}
+
 /*
  * Δv = J / m
  */
@@ -102,6 +122,7 @@ void Body::apply_impulse_linear(const Vec2 &j) {
     if (is_static()) {
         return;
     }
+    set_awake(true);
 
     velocity += j * inv_mass;
 }
@@ -110,6 +131,7 @@ void Body::apply_impulse_angular(const float j) {
     if (is_static()) {
         return;
     }
+    set_awake(true);
 
     angular_vel += j * inv_I;
 }
@@ -119,13 +141,37 @@ void Body::apply_impulse_at_point(const Vec2 &j, const Vec2 &r) {
     if (is_static()) {
         return;
     }
+    set_awake(true);
 
     velocity += j * inv_mass;
     angular_vel += r.cross(j) * inv_I;
 }
 
+void Body::save_pose() {
+    prev_position = position;
+    prev_rotation = rotation;
+}
+
+Vec2 Body::get_interpolated_position(float alpha) const {
+    return prev_position + (position - prev_position) * alpha;
+}
+
+float Body::get_interpolated_rotation(float alpha) const {
+    return prev_rotation + (rotation - prev_rotation) * alpha;
+}
+
+void Body::update_transform() {
+    update_rotation();
+    shape->update_vertices(cos_rotation, sin_rotation, position);
+}
+
+void Body::update_rotation() {
+    cos_rotation = cos(rotation);
+    sin_rotation = sin(rotation);
+}
+
 Vec2 Body::localspace_to_worldspace(const Vec2 &point) const {
-    Vec2 rotated = point.rotate(rotation);
+    Vec2 rotated = point.rotate(cos_rotation, sin_rotation);
     return rotated + position;
 }
 Vec2 Body::worldspace_to_localspace(const Vec2 &point) const {
@@ -134,10 +180,9 @@ Vec2 Body::worldspace_to_localspace(const Vec2 &point) const {
     // inverse of the rotation done in localspace_to_worldspace
     // rotation matrix
     //  R = [[cos, -sin], [sin, cos]]
-    float rotated_x =
-        cos(-rotation) * translated_x - sin(-rotation) * translated_y;
-    float rotated_y =
-        cos(-rotation) * translated_y + sin(-rotation) * translated_x;
+    // cos(-a) = cos(a), sin(-a) = -sin(a)
+    float rotated_x = cos_rotation * translated_x + sin_rotation * translated_y;
+    float rotated_y = cos_rotation * translated_y - sin_rotation * translated_x;
     return Vec2(rotated_x, rotated_y);
 }
 
@@ -163,5 +208,15 @@ void Body::integrate_velocities(const float dt) {
 
     position += velocity * dt;
     rotation += angular_vel * dt;
-    shape->update_vertices(rotation, position);
+    update_transform();
+}
+
+void Body::integrate_pose(const float dt) {
+    if (is_static()) {
+        return;
+    }
+
+    position += velocity * dt;
+    rotation += angular_vel * dt;
+    update_rotation();
 }
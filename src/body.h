@@ -3,22 +3,47 @@
 
 #include "shape.h"
 #include "vec2.h"
-#include <SDL2/SDL.h>
-// #include <SDL2/SDL_image.h>
-#include <SDL2/SDL_render.h>
+
+// only used through a pointer, the physics code never needs SDL itself
+struct SDL_Texture;
 
 struct Body {
     // bool is_colliding = false;
 
+    // assigned by the world in the order bodies are added
+    int id = -1;
+    // slot in the world's SolverBodies during a step
+    int solver_index = -1;
+    // slot in the world's Islands during a step
+    int island_index = -1;
+    // slot in the BodyPool the body lives in, -1 if it was made with new
+    int pool_index = -1;
+
+    // sleeping bodies are skipped by the world until something touches them
+    // static bodies are never awake
+    bool is_awake = true;
+    // how long the body has been slower than the sleep tolerances
+    float sleep_time = 0.0f;
+    // fast bodies that would pass through others between two steps
+    // the world sweeps their motion and stops them where they first hit
+    bool is_bullet = false;
+
     // linear motion
     Vec2 position;
     Vec2 velocity;
     Vec2 acceleartion;
 
+    // pose before the last world step, for rendering between steps
+    Vec2 prev_position;
+
     // Angular motion
     float rotation;
     float angular_vel;
     float angular_acc;
+    float prev_rotation;
+    // cos and sin of rotation, refreshed by update_transform()
+    float cos_rotation = 1.0f;
+    float sin_rotation = 0.0f;
 
     // forces and torque
     Vec2 sum_forces;
@@ -36,11 +61,15 @@ struct Body {
     float friction;
 
     Shape *shape = nullptr;
+    // false for shapes placed by a BodyPool, which destroys them itself
+    bool owns_shape = false;
 
-    // pointer to SDL texture
+    // pointer to SDL texture, owned by Graphics, see Graphics::load_texture()
     SDL_Texture *texture = nullptr;
 
     Body(const Shape &shape, float x, float y, float m);
+    // use a shape that lives somewhere else, the body won't delete it
+    Body(Shape *shape, float x, float y, float m);
     ~Body();
 
     // copy constructor
@@ -56,15 +85,30 @@ struct Body {
 
     void update(float dt);
 
-    void set_texture(const char *texture_file_name);
+    // remember the current pose as the one before the next step
+    void save_pose();
+    // pose between the previous and the current step, alpha in [0, 1]
+    Vec2 get_interpolated_position(float alpha) const;
+    float get_interpolated_rotation(float alpha) const;
+
+    // call after changing position or rotation: caches cos/sin of the
+    // rotation and moves the shape's vertices
+    void update_transform();
+    // only the cos/sin part, for when the world moves the shapes itself,
+    // see ShapeBatch
+    void update_rotation();
 
     Vec2 localspace_to_worldspace(const Vec2 &point) const;
     Vec2 worldspace_to_localspace(const Vec2 &point) const;
 
     bool is_static() const;
 
+    // putting a body to sleep stops it, waking it restarts its sleep timer
+    void set_awake(bool awake);
+
     /**
      * Linear impulse, applied at center of mass
+     * Impulses wake the body up
      */
     void apply_impulse_linear(const Vec2 &j);
     /**
@@ -78,6 +122,8 @@ struct Body {
 
     void integrate_forces(const float dt);
     void integrate_velocities(const float dt);
+    // the same but leaves the shape where it is, see update_rotation()
+    void integrate_pose(const float dt);
 };
 
 #endif
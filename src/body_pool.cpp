@@ -0,0 +1,100 @@
+#include "body_pool.h"
+#include "body.h"
+#include "shape.h"
+#include <algorithm>
+#include <functional>
+#include <new>
+#include <vector>
+
+BodyPool::~BodyPool() {
+    const int capacity = get_capacity();
+    for (int i = 0; i < capacity; i++) {
+        Body *body = at(i);
+        if (body) {
+            Shape *shape = body->shape;
+            body->~Body();
+            shape->~Shape();
+        }
+    }
+    for (auto block : blocks) {
+        delete[] block;
+    }
+}
+
+BodyPool::Slot &BodyPool::get_slot(int index) const {
+    return blocks[index / BLOCK_SIZE][index % BLOCK_SIZE];
+}
+
+BodyHandle BodyPool::create(const Shape &shape, float x, float y,
+                            float mass) {
+    if (free_slots.empty()) {
+        const int first = get_capacity();
+        blocks.push_back(new Slot[BLOCK_SIZE]);
+        for (int i = 0; i < BLOCK_SIZE; i++) {
+            free_slots.push_back(first + i);
+        }
+        std::make_heap(free_slots.begin(), free_slots.end(),
+                       std::greater<int>());
+    }
+
+    std::pop_heap(free_slots.begin(), free_slots.end(), std::greater<int>());
+    const int index = free_slots.back();
+    free_slots.pop_back();
+
+    Slot &slot = get_slot(index);
+    Shape *slot_shape = shape.clone_at(slot.shape);
+    Body *body = new (slot.body) Body(slot_shape, x, y, mass);
+    body->pool_index = index;
+    slot.alive = true;
+    count++;
+
+    return {index, slot.generation};
+}
+
+void BodyPool::destroy(BodyHandle handle) {
+    Body *body = get(handle);
+    if (!body) {
+        return;
+    }
+
+    Shape *shape = body->shape;
+    body->~Body();
+    shape->~Shape();
+
+    Slot &slot = get_slot(handle.index);
+    slot.alive = false;
+    slot.generation++;
+    count--;
+
+    free_slots.push_back(handle.index);
+    std::push_heap(free_slots.begin(), free_slots.end(), std::greater<int>());
+}
+
+Body *BodyPool::get(BodyHandle handle) const {
+    if (handle.index < 0 || handle.index >= get_capacity()) {
+        return nullptr;
+    }
+    Slot &slot = get_slot(handle.index);
+    if (!slot.alive || slot.generation != handle.generation) {
+        return nullptr;
+    }
+    return (Body *)slot.body;
+}
+
+BodyHandle BodyPool::get_handle(const Body *body) const {
+    if (body->pool_index < 0) {
+        return {};
+    }
+    return {body->pool_index, get_slot(body->pool_index).generation};
+}
+
+int BodyPool::get_capacity() const {
+    return (int)blocks.size() * BLOCK_SIZE;
+}
+
+Body *BodyPool::at(int index) const {
+    Slot &slot = get_slot(index);
+    return slot.alive ? (Body *)slot.body : nullptr;
+}
+
+int BodyPool::get_count() const { return count; }
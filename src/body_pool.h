@@ -0,0 +1,68 @@
+#ifndef BODY_POOL_H
+#define BODY_POOL_H
+
+#include "body.h"
+#include "shape.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Refers to a body in a BodyPool
+ * The generation changes whenever the slot is freed, so a handle to a
+ * destroyed body stays invalid even after its slot is reused.
+ */
+struct BodyHandle {
+    int index = -1;
+    uint32_t generation = 0;
+
+    bool operator==(const BodyHandle &other) const = default;
+};
+
+/**
+ * Stores bodies and their shapes in blocks of slots
+ * Each slot holds the body and its shape next to each other, and blocks
+ * never move, so Body pointers stay valid until the body is destroyed.
+ * New bodies take the lowest free slot, which keeps live bodies packed at
+ * the front and iteration over slots walking contiguous memory.
+ */
+class BodyPool {
+  private:
+    static const int BLOCK_SIZE = 256;
+
+    struct Slot {
+        alignas(Body) unsigned char body[sizeof(Body)];
+        alignas(std::max_align_t) unsigned char shape[MAX_SHAPE_SIZE];
+        uint32_t generation = 0;
+        bool alive = false;
+    };
+
+    std::vector<Slot *> blocks;
+    // min-heap of free slot indices
+    std::vector<int> free_slots;
+    int count = 0;
+
+    Slot &get_slot(int index) const;
+
+  public:
+    BodyPool() = default;
+    ~BodyPool();
+
+    BodyPool(const BodyPool &) = delete;
+    BodyPool &operator=(const BodyPool &) = delete;
+
+    BodyHandle create(const Shape &shape, float x, float y, float mass);
+    // does nothing for a stale handle
+    void destroy(BodyHandle handle);
+
+    // nullptr if the body has been destroyed
+    Body *get(BodyHandle handle) const;
+    BodyHandle get_handle(const Body *body) const;
+
+    // slots ever used, live or not; at() returns nullptr for free ones
+    int get_capacity() const;
+    Body *at(int index) const;
+    int get_count() const;
+};
+
+#endif
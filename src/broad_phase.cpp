@@ -0,0 +1,526 @@
+#include "broad_phase.h"
+#include "aabb.h"
+#include "body.h"
+#include "dynamic_tree.h"
+#include "shape.h"
+#include "task_scheduler.h"
+#include "vec2.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iterator>
+#include <vector>
+
+bool BodyPair::operator<(const BodyPair &other) const {
+    return a->id < other.a->id || (a->id == other.a->id && b->id < other.b->id);
+}
+
+uint64_t BodyPair::key() const {
+    return ((uint64_t)(uint32_t)a->id << 32) | (uint32_t)b->id;
+}
+
+void WorkerPairs::reset(TaskScheduler *scheduler) {
+    pairs.resize(scheduler ? scheduler->get_num_workers() : 1);
+    for (auto &worker : pairs) {
+        worker.clear();
+    }
+}
+
+void WorkerPairs::merge_into(std::vector<BodyPair> &out) const {
+    const size_t first = out.size();
+    for (auto &worker : pairs) {
+        out.insert(out.end(), worker.begin(), worker.end());
+    }
+    std::sort(out.begin() + first, out.end());
+    out.erase(std::unique(out.begin() + first, out.end(),
+                          [](const BodyPair &lhs, const BodyPair &rhs) {
+                              return lhs.a == rhs.a && lhs.b == rhs.b;
+                          }),
+              out.end());
+}
+
+void run_parallel(TaskScheduler *scheduler, int count, int grain,
+                  const std::function<void(int, int, int)> &fn) {
+    if (scheduler) {
+        scheduler->parallel_for(count, grain, fn);
+    } else if (count > 0) {
+        fn(0, count, 0);
+    }
+}
+
+void BroadPhase::set_scheduler(TaskScheduler *scheduler) {
+    this->scheduler = scheduler;
+}
+
+void BroadPhase::query(const AABB &aabb, const std::vector<Body *> &bodies,
+                       std::vector<Body *> &out) const {
+    for (auto body : bodies) {
+        if (aabb.overlaps(body->shape->aabb)) {
+            out.push_back(body);
+        }
+    }
+}
+
+const std::vector<BodyPair> &
+BruteForceBroadPhase::find_pairs(const std::vector<Body *> &bodies) {
+    pairs.clear();
+    for (size_t i = 0; i < bodies.size(); i++) {
+        const AABB &aabb = bodies[i]->shape->aabb;
+        for (size_t j = i + 1; j < bodies.size(); j++) {
+            if (aabb.overlaps(bodies[j]->shape->aabb)) {
+                pairs.push_back({bodies[i], bodies[j]});
+            }
+        }
+    }
+    return pairs;
+}
+
+UniformGridBroadPhase::UniformGridBroadPhase(float cell_size)
+    : cell_size(cell_size) {}
+
+void UniformGridBroadPhase::set_cell_size(float cell_size) {
+    this->cell_size = cell_size;
+}
+
+float UniformGridBroadPhase::get_cell_size() const { return cell_size; }
+
+/**
+ * 1. bin every body into the cells covered by its AABB
+ * 2. sort the (cell, body) entries so bodies sharing a cell are adjacent
+ * 3. test AABBs of bodies within the same cell
+ * 4. a pair that shares several cells is found several times, so sort and
+ *    remove duplicates
+ */
+const std::vector<BodyPair> &
+UniformGridBroadPhase::find_pairs(const std::vector<Body *> &bodies) {
+    pairs.clear();
+    aabbs.clear();
+    entries.clear();
+    candidates.clear();
+
+    const float inv_cell_size = 1.0f / cell_size;
+
+    for (size_t i = 0; i < bodies.size(); i++) {
+        const AABB &aabb = bodies[i]->shape->aabb;
+        aabbs.push_back(aabb);
+
+        const int64_t min_x = (int64_t)std::floor(aabb.min.x * inv_cell_size);
+        const int64_t min_y = (int64_t)std::floor(aabb.min.y * inv_cell_size);
+        const int64_t max_x = (int64_t)std::floor(aabb.max.x * inv_cell_size);
+        const int64_t max_y = (int64_t)std::floor(aabb.max.y * inv_cell_size);
+
+        for (int64_t y = min_y; y <= max_y; y++) {
+            for (int64_t x = min_x; x <= max_x; x++) {
+                // pack both cell coordinates into one key
+                const int64_t cell = (y << 32) ^ (x & 0xFFFFFFFF);
+                entries.push_back({cell, (int)i});
+            }
+        }
+    }
+
+    std::sort(entries.begin(), entries.end(),
+              [](const CellEntry &lhs, const CellEntry &rhs) {
+                  return lhs.cell < rhs.cell ||
+                         (lhs.cell == rhs.cell && lhs.body < rhs.body);
+              });
+
+    // every entry is tested against the entries after it in the same cell
+    worker_candidates.resize(scheduler ? scheduler->get_num_workers() : 1);
+    for (auto &worker : worker_candidates) {
+        worker.clear();
+    }
+    run_parallel(
+        scheduler, (int)entries.size(), 256,
+        [&](int begin, int end, int worker) {
+            for (int i = begin; i < end; i++) {
+                for (size_t j = i + 1; j < entries.size() &&
+                                       entries[j].cell == entries[i].cell;
+                     j++) {
+                    const int a = entries[i].body;
+                    const int b = entries[j].body;
+                    if (aabbs[a].overlaps(aabbs[b])) {
+                        worker_candidates[worker].push_back({a, b});
+                    }
+                }
+            }
+        });
+    for (auto &worker : worker_candidates) {
+        candidates.insert(candidates.end(), worker.begin(), worker.end());
+    }
+
+    // bodies are stored in the order they were added, so sorting by index
+    // gives the same order as the brute force loop
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()),
+                     candidates.end());
+
+    for (auto &candidate : candidates) {
+        pairs.push_back({bodies[candidate.first], bodies[candidate.second]});
+    }
+    return pairs;
+}
+
+bool DynamicTreeBroadPhase::TreePair::operator<(const TreePair &other) const {
+    return pair < other.pair;
+}
+
+DynamicTreeBroadPhase::DynamicTreeBroadPhase(float margin) : tree(margin) {}
+
+void DynamicTreeBroadPhase::add_body(Body *body) {
+    int proxy_id = tree.create_proxy(body->shape->aabb, body);
+    proxies[body] = proxy_id;
+    move_buffer.push_back(proxy_id);
+}
+
+void DynamicTreeBroadPhase::remove_body(Body *body) {
+    auto it = proxies.find(body);
+    if (it == proxies.end()) {
+        return;
+    }
+    int proxy_id = it->second;
+    proxies.erase(it);
+
+    move_buffer.erase(
+        std::remove(move_buffer.begin(), move_buffer.end(), proxy_id),
+        move_buffer.end());
+
+    // drop every pair the body was part of
+    current_pairs.erase(std::remove_if(current_pairs.begin(),
+                                       current_pairs.end(),
+                                       [&](const TreePair &pair) {
+                                           return pair.proxy_a == proxy_id ||
+                                                  pair.proxy_b == proxy_id;
+                                       }),
+                        current_pairs.end());
+    pairs.erase(std::remove_if(pairs.begin(), pairs.end(),
+                               [&](const BodyPair &pair) {
+                                   return pair.a == body || pair.b == body;
+                               }),
+                pairs.end());
+
+    tree.destroy_proxy(proxy_id);
+}
+
+void DynamicTreeBroadPhase::update_body(Body *body) {
+    auto it = proxies.find(body);
+    if (it == proxies.end()) {
+        return;
+    }
+
+    if (tree.move_proxy(it->second, body->shape->aabb)) {
+        move_buffer.push_back(it->second);
+    }
+}
+
+/**
+ * 1. drop pairs whose fat AABBs stopped overlapping
+ * 2. every proxy that was (re)inserted queries the tree for new pairs
+ * 3. merge the new pairs into the sorted list of current pairs
+ */
+const std::vector<BodyPair> &DynamicTreeBroadPhase::find_pairs(
+    [[maybe_unused]] const std::vector<Body *> &bodies) {
+    new_pairs.clear();
+    lost_pairs.clear();
+
+    size_t count = 0;
+    for (auto &pair : current_pairs) {
+        const AABB &fat_a = tree.get_fat_aabb(pair.proxy_a);
+        const AABB &fat_b = tree.get_fat_aabb(pair.proxy_b);
+        if (fat_a.overlaps(fat_b)) {
+            current_pairs[count++] = pair;
+        } else {
+            lost_pairs.push_back(pair.pair);
+        }
+    }
+    current_pairs.resize(count);
+
+    // query the tree for every moved proxy in parallel; a pair is found
+    // twice when both bodies moved, merging removes the duplicates
+    query_pairs.resize(scheduler ? scheduler->get_num_workers() : 1);
+    for (auto &worker : query_pairs) {
+        worker.clear();
+    }
+    run_parallel(
+        scheduler, (int)move_buffer.size(), 64,
+        [&](int begin, int end, int worker) {
+            std::vector<TreePair> &out = query_pairs[worker];
+            for (int i = begin; i < end; i++) {
+                const int proxy_id = move_buffer[i];
+                Body *body = tree.get_body(proxy_id);
+                tree.query(tree.get_fat_aabb(proxy_id), [&](int other_id) {
+                    if (other_id == proxy_id) {
+                        return true;
+                    }
+
+                    Body *other = tree.get_body(other_id);
+                    out.push_back(
+                        body->id < other->id
+                            ? TreePair{{body, other}, proxy_id, other_id}
+                            : TreePair{{other, body}, other_id, proxy_id});
+                    return true;
+                });
+            }
+        });
+    move_buffer.clear();
+
+    found_pairs.clear();
+    for (auto &worker : query_pairs) {
+        found_pairs.insert(found_pairs.end(), worker.begin(), worker.end());
+    }
+    std::sort(found_pairs.begin(), found_pairs.end());
+    found_pairs.erase(std::unique(found_pairs.begin(), found_pairs.end(),
+                                  [](const TreePair &lhs, const TreePair &rhs) {
+                                      return lhs.proxy_a == rhs.proxy_a &&
+                                             lhs.proxy_b == rhs.proxy_b;
+                                  }),
+                      found_pairs.end());
+    // both are sorted, the pairs found that aren't current yet are new
+    added_pairs.clear();
+    std::set_difference(found_pairs.begin(), found_pairs.end(),
+                        current_pairs.begin(), current_pairs.end(),
+                        std::back_inserter(added_pairs));
+    for (auto &pair : added_pairs) {
+        new_pairs.push_back(pair.pair);
+    }
+
+    // both lists are sorted, merge into the spare buffer and swap so the
+    // merge doesn't allocate
+    merged_pairs.resize(current_pairs.size() + added_pairs.size());
+    std::merge(current_pairs.begin(), current_pairs.end(),
+               added_pairs.begin(), added_pairs.end(), merged_pairs.begin());
+    current_pairs.swap(merged_pairs);
+
+    pairs.resize(current_pairs.size());
+    for (size_t i = 0; i < current_pairs.size(); i++) {
+        pairs[i] = current_pairs[i].pair;
+    }
+    return pairs;
+}
+
+void DynamicTreeBroadPhase::query(
+    const AABB &aabb, [[maybe_unused]] const std::vector<Body *> &bodies,
+    std::vector<Body *> &out) const {
+    tree.query(aabb, [&](int proxy_id) {
+        out.push_back(tree.get_body(proxy_id));
+        return true;
+    });
+}
+
+const std::vector<BodyPair> &DynamicTreeBroadPhase::get_new_pairs() const {
+    return new_pairs;
+}
+
+const std::vector<BodyPair> &DynamicTreeBroadPhase::get_lost_pairs() const {
+    return lost_pairs;
+}
+
+const DynamicTree &DynamicTreeBroadPhase::get_tree() const { return tree; }
+
+float SweepAndPruneBroadPhase::endpoint_value(const Endpoint &endpoint,
+                                              int axis) const {
+    const AABB &aabb = sap_proxies[endpoint.proxy].aabb;
+    const Vec2 &bound = endpoint.is_min ? aabb.min : aabb.max;
+    return axis == 0 ? bound.x : bound.y;
+}
+
+void SweepAndPruneBroadPhase::add_body(Body *body) {
+    int proxy_id;
+    if (free_proxies.empty()) {
+        proxy_id = sap_proxies.size();
+        sap_proxies.push_back({body, body->shape->aabb});
+    } else {
+        proxy_id = free_proxies.back();
+        free_proxies.pop_back();
+        sap_proxies[proxy_id] = {body, body->shape->aabb};
+    }
+    proxy_ids[body] = proxy_id;
+
+    // append the new endpoints and let insertion sort move them into place;
+    // the swaps on the way report every body the new one overlaps
+    for (int axis = 0; axis < 2; axis++) {
+        Endpoint min{0.0f, proxy_id, true};
+        Endpoint max{0.0f, proxy_id, false};
+        min.value = endpoint_value(min, axis);
+        max.value = endpoint_value(max, axis);
+        endpoints[axis].push_back(min);
+        endpoints[axis].push_back(max);
+        sort_axis(axis);
+    }
+}
+
+void SweepAndPruneBroadPhase::remove_body(Body *body) {
+    auto it = proxy_ids.find(body);
+    if (it == proxy_ids.end()) {
+        return;
+    }
+    int proxy_id = it->second;
+    proxy_ids.erase(it);
+
+    for (int axis = 0; axis < 2; axis++) {
+        auto &axis_endpoints = endpoints[axis];
+        axis_endpoints.erase(
+            std::remove_if(axis_endpoints.begin(), axis_endpoints.end(),
+                           [proxy_id](const Endpoint &endpoint) {
+                               return endpoint.proxy == proxy_id;
+                           }),
+            axis_endpoints.end());
+    }
+
+    for (auto pair = pair_map.begin(); pair != pair_map.end();) {
+        if (pair->second.a == body || pair->second.b == body) {
+            pair = pair_map.erase(pair);
+            pairs_changed = true;
+        } else {
+            pair++;
+        }
+    }
+
+    sap_proxies[proxy_id].body = nullptr;
+    free_proxies.push_back(proxy_id);
+}
+
+void SweepAndPruneBroadPhase::add_pair(int proxy_a, int proxy_b) {
+    if (!sap_proxies[proxy_a].aabb.overlaps(sap_proxies[proxy_b].aabb)) {
+        // they only overlap on this axis
+        return;
+    }
+
+    Body *a = sap_proxies[proxy_a].body;
+    Body *b = sap_proxies[proxy_b].body;
+    BodyPair pair = a->id < b->id ? BodyPair{a, b} : BodyPair{b, a};
+    if (pair_map.insert({pair.key(), pair}).second) {
+        pairs_changed = true;
+    }
+}
+
+void SweepAndPruneBroadPhase::remove_pair(int proxy_a, int proxy_b) {
+    Body *a = sap_proxies[proxy_a].body;
+    Body *b = sap_proxies[proxy_b].body;
+    BodyPair pair = a->id < b->id ? BodyPair{a, b} : BodyPair{b, a};
+    if (pair_map.erase(pair.key()) > 0) {
+        pairs_changed = true;
+    }
+}
+
+/**
+ * Insertion sort, nearly O(n) when the order barely changed since last frame
+ * On ties min endpoints go first, so touching boxes count as overlapping.
+ */
+void SweepAndPruneBroadPhase::sort_axis(int axis) {
+    auto &axis_endpoints = endpoints[axis];
+    for (size_t i = 1; i < axis_endpoints.size(); i++) {
+        const Endpoint key = axis_endpoints[i];
+        size_t j = i;
+        while (j > 0) {
+            const Endpoint &prev = axis_endpoints[j - 1];
+            bool out_of_order =
+                key.value < prev.value ||
+                (key.value == prev.value && key.is_min && !prev.is_min);
+            if (!out_of_order) {
+                break;
+            }
+
+            if (key.is_min && !prev.is_min) {
+                // a min moved below a max: the two may start overlapping
+                add_pair(key.proxy, prev.proxy);
+            } else if (!key.is_min && prev.is_min) {
+                // a max moved below a min: they can't overlap anymore
+                remove_pair(key.proxy, prev.proxy);
+            }
+
+            axis_endpoints[j] = prev;
+            j--;
+        }
+        axis_endpoints[j] = key;
+    }
+}
+
+const std::vector<BodyPair> &SweepAndPruneBroadPhase::find_pairs(
+    [[maybe_unused]] const std::vector<Body *> &bodies) {
+    for (auto &proxy : sap_proxies) {
+        if (proxy.body) {
+            proxy.aabb = proxy.body->shape->aabb;
+        }
+    }
+
+    for (int axis = 0; axis < 2; axis++) {
+        for (auto &endpoint : endpoints[axis]) {
+            endpoint.value = endpoint_value(endpoint, axis);
+        }
+        sort_axis(axis);
+    }
+
+    if (pairs_changed) {
+        sorted_pairs.clear();
+        for (auto &pair : pair_map) {
+            sorted_pairs.push_back(pair.second);
+        }
+        std::sort(sorted_pairs.begin(), sorted_pairs.end());
+        pairs_changed = false;
+    }
+
+    return sorted_pairs;
+}
+
+StaticGeometry::StaticGeometry() : tree(0.0f) {}
+
+void StaticGeometry::set_scheduler(TaskScheduler *scheduler) {
+    this->scheduler = scheduler;
+}
+
+void StaticGeometry::add_body(Body *body) {
+    bodies.push_back(body);
+    dirty = true;
+}
+
+void StaticGeometry::remove_body(Body *body) {
+    auto it = std::find(bodies.begin(), bodies.end(), body);
+    if (it == bodies.end()) {
+        return;
+    }
+    bodies.erase(it);
+    dirty = true;
+}
+
+void StaticGeometry::build() {
+    tree = DynamicTree(0.0f);
+    for (auto body : bodies) {
+        tree.create_proxy(body->shape->aabb, body);
+    }
+    dirty = false;
+}
+
+void StaticGeometry::find_pairs(const std::vector<Body *> &dynamic_bodies,
+                                std::vector<BodyPair> &pairs) {
+    if (dirty) {
+        build();
+    }
+
+    query_pairs.reset(scheduler);
+    run_parallel(scheduler, (int)dynamic_bodies.size(), 64,
+                 [&](int begin, int end, int worker) {
+                     std::vector<BodyPair> &out = query_pairs.pairs[worker];
+                     for (int i = begin; i < end; i++) {
+                         Body *body = dynamic_bodies[i];
+                         tree.query(body->shape->aabb, [&](int proxy_id) {
+                             Body *other = tree.get_body(proxy_id);
+                             out.push_back(body->id < other->id
+                                               ? BodyPair{body, other}
+                                               : BodyPair{other, body});
+                             return true;
+                         });
+                     }
+                 });
+    query_pairs.merge_into(pairs);
+}
+
+void StaticGeometry::query(const AABB &aabb, std::vector<Body *> &out) {
+    if (dirty) {
+        build();
+    }
+
+    tree.query(aabb, [&](int proxy_id) {
+        out.push_back(tree.get_body(proxy_id));
+        return true;
+    });
+}
@@ -0,0 +1,271 @@
+#ifndef BROAD_PHASE_H
+#define BROAD_PHASE_H
+
+#include "aabb.h"
+#include "body.h"
+#include "dynamic_tree.h"
+#include "task_scheduler.h"
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+enum BroadPhaseType {
+    BRUTE_FORCE,
+    UNIFORM_GRID,
+    DYNAMIC_TREE,
+    SWEEP_AND_PRUNE
+};
+
+/**
+ * Candidate pair handed over to the narrow phase
+ * `a` always has the lower body id, i.e. was added to the world first
+ */
+struct BodyPair {
+    Body *a;
+    Body *b;
+
+    // order by body id, the order of the brute force i < j loop
+    bool operator<(const BodyPair &other) const;
+    // unique key built from both body ids
+    uint64_t key() const;
+};
+
+/**
+ * Pairs found by each worker of a parallel loop, merged and sorted after it
+ * so the result doesn't depend on which worker found what
+ */
+struct WorkerPairs {
+    std::vector<std::vector<BodyPair>> pairs;
+
+    void reset(TaskScheduler *scheduler);
+    // append all pairs to `out`, sorted by body id and without duplicates
+    void merge_into(std::vector<BodyPair> &out) const;
+};
+
+// scheduler->parallel_for() or the whole range inline without a scheduler
+void run_parallel(TaskScheduler *scheduler, int count, int grain,
+                  const std::function<void(int, int, int)> &fn);
+
+class BroadPhase {
+  protected:
+    // runs the parallel parts of find_pairs, optional
+    TaskScheduler *scheduler = nullptr;
+
+  public:
+    virtual ~BroadPhase() = default;
+
+    void set_scheduler(TaskScheduler *scheduler);
+
+    // called when bodies enter or leave the world
+    virtual void add_body([[maybe_unused]] Body *body) {};
+    virtual void remove_body([[maybe_unused]] Body *body) {};
+    // called right after the body integrated its velocities
+    virtual void update_body([[maybe_unused]] Body *body) {};
+
+    /**
+     * Every pair of bodies whose AABBs overlap.
+     * Pairs are sorted by body id, i.e. the same order as the brute force
+     * i < j loop, so the solver sees constraints in the same order whichever
+     * broad phase is used. The list belongs to the broad phase and stays
+     * valid until the next call.
+     */
+    virtual const std::vector<BodyPair> &
+    find_pairs(const std::vector<Body *> &bodies) = 0;
+
+    /**
+     * Append to `out` the bodies whose AABBs may overlap `aabb`, at least
+     * every one of `bodies` that does at its current pose, so moved bodies
+     * must have had update_body() called.
+     * This tests all of them, broad phases that keep the bodies in a
+     * spatial structure look them up there instead.
+     */
+    virtual void query(const AABB &aabb, const std::vector<Body *> &bodies,
+                       std::vector<Body *> &out) const;
+};
+
+// reference implementation, tests every pair on one thread
+class BruteForceBroadPhase : public BroadPhase {
+  private:
+    std::vector<BodyPair> pairs;
+
+  public:
+    const std::vector<BodyPair> &
+    find_pairs(const std::vector<Body *> &bodies) override;
+};
+
+/**
+ * Spatial hash: every body is binned into each grid cell its AABB touches,
+ * and only bodies sharing a cell are tested against each other
+ */
+class UniformGridBroadPhase : public BroadPhase {
+  private:
+    struct CellEntry {
+        int64_t cell;
+        int body;
+    };
+
+    float cell_size;
+
+    // kept between frames so that stepping doesn't reallocate
+    std::vector<AABB> aabbs;
+    std::vector<CellEntry> entries;
+    std::vector<std::pair<int, int>> candidates;
+    std::vector<std::vector<std::pair<int, int>>> worker_candidates;
+    std::vector<BodyPair> pairs;
+
+  public:
+    UniformGridBroadPhase(float cell_size);
+
+    void set_cell_size(float cell_size);
+    float get_cell_size() const;
+
+    const std::vector<BodyPair> &
+    find_pairs(const std::vector<Body *> &bodies) override;
+};
+
+/**
+ * Dynamic AABB tree broad phase
+ * Bodies keep a fat AABB in the tree and are only reinserted once they move
+ * out of it. Pairs persist between frames: only bodies that were reinserted
+ * query the tree for new pairs, and a pair is lost once the fat AABBs of its
+ * bodies stop overlapping.
+ */
+class DynamicTreeBroadPhase : public BroadPhase {
+  private:
+    // a pair together with the proxies of its bodies, so checking whether
+    // it still overlaps doesn't have to look the proxies up
+    struct TreePair {
+        BodyPair pair;
+        int proxy_a;
+        int proxy_b;
+
+        bool operator<(const TreePair &other) const;
+    };
+
+    DynamicTree tree;
+    std::unordered_map<Body *, int> proxies;
+    // proxies that were inserted or reinserted since the last find_pairs
+    std::vector<int> move_buffer;
+
+    // current pairs, sorted by body id
+    std::vector<TreePair> current_pairs;
+    // new pairs are merged in here, then swapped with current_pairs
+    std::vector<TreePair> merged_pairs;
+    // the body pairs of current_pairs, handed out by find_pairs
+    std::vector<BodyPair> pairs;
+
+    std::vector<BodyPair> new_pairs;
+    std::vector<BodyPair> lost_pairs;
+    // pairs found by the queries of moved proxies, one list per worker
+    std::vector<std::vector<TreePair>> query_pairs;
+    // sorted and without duplicates
+    std::vector<TreePair> found_pairs;
+    // found pairs that weren't current yet
+    std::vector<TreePair> added_pairs;
+
+  public:
+    DynamicTreeBroadPhase(float margin);
+
+    void add_body(Body *body) override;
+    void remove_body(Body *body) override;
+    void update_body(Body *body) override;
+
+    const std::vector<BodyPair> &
+    find_pairs(const std::vector<Body *> &bodies) override;
+    // every body whose fat AABB overlaps `aabb`
+    void query(const AABB &aabb, const std::vector<Body *> &bodies,
+               std::vector<Body *> &out) const override;
+
+    // pairs that started or stopped overlapping in the last find_pairs
+    // pairs of removed bodies are dropped without being reported
+    const std::vector<BodyPair> &get_new_pairs() const;
+    const std::vector<BodyPair> &get_lost_pairs() const;
+
+    const DynamicTree &get_tree() const;
+};
+
+/**
+ * Incremental sort and sweep (sweep and prune)
+ * The min/max endpoints of every body's AABB are kept sorted along both axes
+ * between frames and fixed up with insertion sort. Every swap of a min and a
+ * max endpoint is exactly where two bodies start or stop overlapping on that
+ * axis, so the pair set is updated from the swaps alone. For a scene that
+ * barely moves this is close to linear in the number of bodies.
+ * The swaps have to be done in order, so it runs on one thread.
+ */
+class SweepAndPruneBroadPhase : public BroadPhase {
+  private:
+    struct Endpoint {
+        float value;
+        int proxy;
+        bool is_min;
+    };
+
+    struct Proxy {
+        Body *body;
+        AABB aabb;
+    };
+
+    std::vector<Proxy> sap_proxies;
+    std::vector<int> free_proxies;
+    std::unordered_map<Body *, int> proxy_ids;
+
+    // sorted endpoints along the x and the y axis
+    std::vector<Endpoint> endpoints[2];
+
+    std::unordered_map<uint64_t, BodyPair> pair_map;
+    // sorted by body id, rebuilt only when pair_map changes
+    std::vector<BodyPair> sorted_pairs;
+    bool pairs_changed = false;
+
+    float endpoint_value(const Endpoint &endpoint, int axis) const;
+    void sort_axis(int axis);
+    void add_pair(int proxy_a, int proxy_b);
+    void remove_pair(int proxy_a, int proxy_b);
+
+  public:
+    void add_body(Body *body) override;
+    void remove_body(Body *body) override;
+
+    const std::vector<BodyPair> &
+    find_pairs(const std::vector<Body *> &bodies) override;
+};
+
+/**
+ * Static scenery (bodies with no mass) lives in its own tree that is built
+ * once and never refitted, since static bodies don't move. Dynamic bodies are
+ * queried against it for dynamic-static pairs, so static-static pairs are
+ * never generated at all.
+ */
+class StaticGeometry {
+  private:
+    DynamicTree tree;
+    std::vector<Body *> bodies;
+    // set when static bodies are added or removed, the tree is rebuilt on
+    // the next query
+    bool dirty = false;
+
+    TaskScheduler *scheduler = nullptr;
+    WorkerPairs query_pairs;
+
+    void build();
+
+  public:
+    StaticGeometry();
+
+    void set_scheduler(TaskScheduler *scheduler);
+    void add_body(Body *body);
+    void remove_body(Body *body);
+
+    /**
+     * Append every (static, dynamic) pair whose AABBs overlap to `pairs`
+     * Pairs are sorted by body id.
+     */
+    void find_pairs(const std::vector<Body *> &dynamic_bodies,
+                    std::vector<BodyPair> &pairs);
+    // append the static bodies whose AABBs overlap `aabb` to `out`
+    void query(const AABB &aabb, std::vector<Body *> &out);
+};
+
+#endif
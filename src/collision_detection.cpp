@@ -1,47 +1,61 @@
 #include "collision_detection.h"
+#include "constants.h"
 #include "contact.h"
-#include "graphics.h"
+#include "frame_arena.h"
+#include "separation.h"
 #include "shape.h"
 #include "vec2.h"
-#include <iostream>
+#include <cstddef>
 #include <limits>
 #include <vector>
 
-bool CollisionDetection::is_colliding(Body *a, Body *b,
-                                      std::vector<Contact> &contacts) {
-    bool a_is_circle = a->shape->get_type() == CIRCLE;
-    bool b_is_circle = b->shape->get_type() == CIRCLE;
-    bool a_is_polygon =
-        a->shape->get_type() == POLYGON || a->shape->get_type() == BOX;
-    bool b_is_polygon =
-        b->shape->get_type() == POLYGON || b->shape->get_type() == BOX;
-
-    if (a_is_circle && b_is_circle) {
-        return is_colliding_circle_circle(a, b, contacts);
-    }
+// indexed by [a's shape type][b's shape type], boxes are polygons except
+// against each other
+constexpr CollisionDetection::CollideFunction
+    dispatch_table[NUM_SHAPE_TYPES][NUM_SHAPE_TYPES] = {
+        {CollisionDetection::is_colliding_circle_circle,
+         CollisionDetection::is_colliding_circle_polygon,
+         CollisionDetection::is_colliding_circle_polygon},
+        {CollisionDetection::is_colliding_polygon_circle,
+         CollisionDetection::is_colliding_polygon_polygon,
+         CollisionDetection::is_colliding_polygon_polygon},
+        {CollisionDetection::is_colliding_polygon_circle,
+         CollisionDetection::is_colliding_polygon_polygon,
+         CollisionDetection::is_colliding_box_box},
+};
+
+CollisionDetection::CollideFunction CollisionDetection::dispatch(ShapeType a,
+                                                                ShapeType b) {
+    return dispatch_table[a][b];
+}
 
-    if (a_is_polygon && b_is_polygon) {
-        return is_colliding_polygon_polygon(a, b, contacts);
+bool CollisionDetection::is_colliding(Body *a, Body *b,
+                                      std::vector<Contact> &contacts,
+                                      FrameArena &arena,
+                                      float speculative_distance) {
+    // cheap rejection on the cached bounds before any shape specific test
+    // the dynamic tree pairs bodies by their fat bounds, so not every pair
+    // it hands over overlaps; with speculative contacts the bounds are
+    // already swept by the motion of the step
+    if (!a->shape->aabb.overlaps(b->shape->aabb)) {
+        return false;
     }
 
-    if (a_is_polygon && b_is_circle) {
-        return is_colliding_polygon_circle(a, b, contacts);
-    }
-    if (a_is_circle && b_is_polygon) {
-        return is_colliding_polygon_circle(b, a, contacts);
-    }
-    return false;
+    return dispatch(a->shape->type, b->shape->type)(a, b, contacts, arena,
+                                                    speculative_distance);
 }
 
 bool CollisionDetection::is_colliding_circle_circle(
-    Body *a, Body *b, std::vector<Contact> &contacts) {
+    Body *a, Body *b, std::vector<Contact> &contacts,
+    [[maybe_unused]] FrameArena &arena, float speculative_distance) {
     CircleShape *a_shape = (CircleShape *)a->shape;
     CircleShape *b_shape = (CircleShape *)b->shape;
 
     const Vec2 ab = b->position - a->position;
     const auto sum_radius = a_shape->radius + b_shape->radius;
 
-    bool is_colliding = ab.mag_sqaure() <= sum_radius * sum_radius;
+    const float reach = sum_radius + speculative_distance;
+    bool is_colliding = ab.mag_sqaure() <= reach * reach;
     if (!is_colliding) {
         return false;
     }
@@ -54,7 +68,8 @@ bool CollisionDetection::is_colliding_circle_circle(
     contact.normal.normalize();
     contact.start = b->position - contact.normal * b_shape->radius;
     contact.end = a->position + contact.normal * a_shape->radius;
-    contact.depth = (contact.end - contact.start).mag();
+    // negative for speculative contacts
+    contact.depth = (contact.end - contact.start).dot(contact.normal);
 
     contacts.push_back(contact);
 
@@ -62,7 +77,8 @@ bool CollisionDetection::is_colliding_circle_circle(
 }
 
 bool CollisionDetection::is_colliding_polygon_polygon(
-    Body *a, Body *b, std::vector<Contact> &contacts) {
+    Body *a, Body *b, std::vector<Contact> &contacts, FrameArena &arena,
+    float speculative_distance) {
     // find separation between a and b, _and_ b and a
     PolygonShape *a_polygon_shape = (PolygonShape *)a->shape;
     PolygonShape *b_polygon_shape = (PolygonShape *)b->shape;
@@ -73,20 +89,61 @@ bool CollisionDetection::is_colliding_polygon_polygon(
 
     float ab_sep = a_polygon_shape->find_min_separation(
         b_polygon_shape, a_index_ref_edge, a_support_point);
-    if (ab_sep >= 0) {
+    if (ab_sep >= speculative_distance) {
         return false;
     }
 
     float ba_sep = b_polygon_shape->find_min_separation(
         a_polygon_shape, b_index_ref_edge, b_support_point);
-    if (ba_sep >= 0) {
+    if (ba_sep >= speculative_distance) {
+        return false;
+    }
+
+    return clip_polygon_contacts(a, b, ab_sep, a_index_ref_edge, ba_sep,
+                                 b_index_ref_edge, contacts, arena,
+                                 speculative_distance);
+}
+
+bool CollisionDetection::is_colliding_box_box(Body *a, Body *b,
+                                              std::vector<Contact> &contacts,
+                                              FrameArena &arena,
+                                              float speculative_distance) {
+    // same test as two polygons, with the separation of 4 by 4 vertices
+    // unrolled
+    const Vec2 *a_vertices = ((PolygonShape *)a->shape)->world_vertices.data();
+    const Vec2 *b_vertices = ((PolygonShape *)b->shape)->world_vertices.data();
+    int a_index_ref_edge, b_index_ref_edge;
+
+    float ab_sep = box_min_separation(a_vertices, b_vertices, a_index_ref_edge);
+    if (ab_sep >= speculative_distance) {
         return false;
     }
 
+    float ba_sep = box_min_separation(b_vertices, a_vertices, b_index_ref_edge);
+    if (ba_sep >= speculative_distance) {
+        return false;
+    }
+
+    return clip_polygon_contacts(a, b, ab_sep, a_index_ref_edge, ba_sep,
+                                 b_index_ref_edge, contacts, arena,
+                                 speculative_distance);
+}
+
+bool CollisionDetection::clip_polygon_contacts(
+    Body *a, Body *b, float ab_sep, int a_index_ref_edge, float ba_sep,
+    int b_index_ref_edge, std::vector<Contact> &contacts, FrameArena &arena,
+    float speculative_distance) {
+    PolygonShape *a_polygon_shape = (PolygonShape *)a->shape;
+    PolygonShape *b_polygon_shape = (PolygonShape *)b->shape;
+
     PolygonShape *ref_shape;
     PolygonShape *incident_shape;
     int index_ref_edge;
-    if (ab_sep > ba_sep) {
+    // keep A as reference unless B is clearly better, otherwise evenly
+    // matched pairs (like stacked boxes) flip the reference edge every frame
+    // and their contact ids never match
+    const float reference_tolerance = 0.1f * LINEAR_SLOP;
+    if (ba_sep <= ab_sep + reference_tolerance) {
         // set "A" as ref shape
         // set "B" as incident shape
         ref_shape = a_polygon_shape;
@@ -112,8 +169,14 @@ bool CollisionDetection::is_colliding_polygon_polygon(
     Vec2 v0 = incident_shape->world_vertices[incident_index];
     Vec2 v1 = incident_shape->world_vertices[incident_next_index];
 
-    std::vector<Vec2> contact_points = {v0, v1};
-    std::vector<Vec2> clipped_points = contact_points;
+    // incident vertices keep their index as feature, points created by a
+    // side plane get the side plane's edge index with the high bit set
+    ClipVertex *contact_points = arena.allocate<ClipVertex>(2);
+    ClipVertex *clipped_points = arena.allocate<ClipVertex>(2);
+    contact_points[0] = {v0, incident_index};
+    contact_points[1] = {v1, incident_next_index};
+    clipped_points[0] = contact_points[0];
+    clipped_points[1] = contact_points[1];
 
     for (size_t i = 0; i < ref_shape->world_vertices.size(); i++) {
         if ((int)i == index_ref_edge)
@@ -123,22 +186,32 @@ bool CollisionDetection::is_colliding_polygon_polygon(
             ref_shape
                 ->world_vertices[(i + 1) % ref_shape->world_vertices.size()];
         int num_clipped = ref_shape->clip_segment_to_line(
-            contact_points, clipped_points, c0, c1);
-        std::cout << "num_clipped: " << num_clipped << std::endl;
-        if (num_clipped < 2)
+            contact_points, clipped_points, c0, c1, 0x80 | (int)i);
+        if (num_clipped < 2) {
+            // only separated shapes clip the incident edge away, which the
+            // speculative distance lets through; touching ones keep the
+            // last clip as before
+            if (speculative_distance > 0.0f) {
+                return false;
+            }
             break;
+        }
 
         // make next contact points the ones that were just clipped
-        contact_points = clipped_points;
+        contact_points[0] = clipped_points[0];
+        contact_points[1] = clipped_points[1];
     }
 
     auto vref = ref_shape->world_vertices[index_ref_edge];
 
     // loop all clipped points, but only consider those where separation is
-    // negative (objects are penetrating each other)
-    for (auto &vclip : clipped_points) {
+    // negative (objects are penetrating each other), or small enough for a
+    // speculative contact
+    for (int k = 0; k < 2; k++) {
+        const ClipVertex &clip_vertex = clipped_points[k];
+        const Vec2 &vclip = clip_vertex.point;
         float separation = (vclip - vref).dot(ref_edge.normal());
-        if (separation <= 0) {
+        if (separation <= speculative_distance) {
             // negative separation means positive penetration
             Contact contact;
             contact.a = a;
@@ -146,7 +219,9 @@ bool CollisionDetection::is_colliding_polygon_polygon(
             contact.normal = ref_edge.normal();
             contact.start = vclip;
             contact.end = vclip + contact.normal * -separation;
-            if (ba_sep >= ab_sep) {
+            contact.id = ((ref_shape == a_polygon_shape ? 0 : 1) << 24) |
+                         (index_ref_edge << 16) | clip_vertex.feature;
+            if (ref_shape == b_polygon_shape) {
                 // the start-end points are always from a to b
                 std::swap(contact.start, contact.end);
                 // the collision normal is always from a to b
@@ -180,11 +255,20 @@ bool CollisionDetection::is_colliding_polygon_polygon(
     */
 }
 
+bool CollisionDetection::is_colliding_circle_polygon(
+    Body *circle, Body *polygon, std::vector<Contact> &contacts,
+    FrameArena &arena, float speculative_distance) {
+    return is_colliding_polygon_circle(polygon, circle, contacts, arena,
+                                       speculative_distance);
+}
+
 bool CollisionDetection::is_colliding_polygon_circle(
-    Body *polygon, Body *circle, std::vector<Contact> &contacts) {
+    Body *polygon, Body *circle, std::vector<Contact> &contacts,
+    [[maybe_unused]] FrameArena &arena, float speculative_distance) {
     const PolygonShape *polygon_shape = (PolygonShape *)polygon->shape;
     const CircleShape *circle_shape = (CircleShape *)circle->shape;
     const std::vector<Vec2> &polygon_vertices = polygon_shape->world_vertices;
+    const float reach = circle_shape->radius + speculative_distance;
 
     Vec2 min_curr_vertex;
     Vec2 min_next_vertex;
@@ -229,7 +313,7 @@ bool CollisionDetection::is_colliding_polygon_circle(
         Vec2 v1 = circle->position - min_curr_vertex;
         Vec2 v2 = min_next_vertex - min_curr_vertex;
         if (v1.dot(v2) < 0) {
-            if (v1.mag() > circle_shape->radius) {
+            if (v1.mag() > reach) {
                 return false;
             } else {
                 // detected collision in region A
@@ -247,7 +331,7 @@ bool CollisionDetection::is_colliding_polygon_circle(
             v2 = min_curr_vertex - min_next_vertex;
             if (v1.dot(v2) < 0) {
                 // inside region B
-                if (v1.mag() > circle_shape->radius) {
+                if (v1.mag() > reach) {
                     return false;
                 } else {
                     contact.a = polygon;
@@ -261,7 +345,7 @@ bool CollisionDetection::is_colliding_polygon_circle(
                 }
             } else {
                 // region C
-                if (distance_circle_edge > circle_shape->radius) {
+                if (distance_circle_edge > reach) {
                     return false;
                 } else {
                     contact.a = polygon;
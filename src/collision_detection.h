@@ -3,17 +3,54 @@
 
 #include "body.h"
 #include "contact.h"
+#include "frame_arena.h"
 #include "shape.h"
 #include <vector>
 
+// scratch memory of the tests comes from `arena`
+// shapes closer than `speculative_distance` get speculative contacts, with
+// a negative depth, 0 only finds overlapping shapes
 struct CollisionDetection {
-    static bool is_colliding(Body *a, Body *b, std::vector<Contact> &contacts);
+    // every pair test has this signature so they fit in one table
+    using CollideFunction = bool (*)(Body *a, Body *b,
+                                     std::vector<Contact> &contacts,
+                                     FrameArena &arena,
+                                     float speculative_distance);
+
+    // the test for a pair of shape types, from a constexpr table
+    static CollideFunction dispatch(ShapeType a, ShapeType b);
+    // looks the test up by both shape types, one indirect call per pair
+    static bool is_colliding(Body *a, Body *b, std::vector<Contact> &contacts,
+                             FrameArena &arena,
+                             float speculative_distance = 0.0f);
     static bool is_colliding_circle_circle(Body *a, Body *b,
-                                           std::vector<Contact> &contact);
+                                           std::vector<Contact> &contact,
+                                           FrameArena &arena,
+                                           float speculative_distance);
     static bool is_colliding_polygon_polygon(Body *a, Body *b,
-                                             std::vector<Contact> &contact);
+                                             std::vector<Contact> &contact,
+                                             FrameArena &arena,
+                                             float speculative_distance);
+    static bool is_colliding_box_box(Body *a, Body *b,
+                                     std::vector<Contact> &contact,
+                                     FrameArena &arena,
+                                     float speculative_distance);
+    // contacts of two overlapping polygons from the reference edge candidates
+    // of both separating axis tests
+    static bool clip_polygon_contacts(Body *a, Body *b, float ab_sep,
+                                      int a_index_ref_edge, float ba_sep,
+                                      int b_index_ref_edge,
+                                      std::vector<Contact> &contacts,
+                                      FrameArena &arena,
+                                      float speculative_distance);
     static bool is_colliding_polygon_circle(Body *polygon, Body *circle,
-                                            std::vector<Contact> &contact);
+                                            std::vector<Contact> &contact,
+                                            FrameArena &arena,
+                                            float speculative_distance);
+    static bool is_colliding_circle_polygon(Body *circle, Body *polygon,
+                                            std::vector<Contact> &contact,
+                                            FrameArena &arena,
+                                            float speculative_distance);
 };
 
 #endif
@@ -6,4 +6,33 @@ const int MS_PER_FRAME = 1000 / FPS;
 
 const int PIXELS_PER_METER = 50;
 
+// penetration allowed before contacts push bodies apart, 1cm
+// keeps resting contacts touching from one frame to the next
+const float LINEAR_SLOP = 0.01f * PIXELS_PER_METER;
+// approach speed below which contacts don't bounce, 1m/s
+const float RESTITUTION_THRESHOLD = 1.0f * PIXELS_PER_METER;
+
+// stiffness of the soft constraints used by the soft step solver
+// contacts are stiff but heavily damped so they don't bounce
+const float CONTACT_HERTZ = 30.0f;
+const float CONTACT_DAMPING_RATIO = 10.0f;
+const float JOINT_HERTZ = 60.0f;
+const float JOINT_DAMPING_RATIO = 2.0f;
+// fastest the soft step solver pushes overlapping bodies apart, 3m/s
+const float MAX_CONTACT_PUSH_VELOCITY = 3.0f * PIXELS_PER_METER;
+
+// two contact manifolds are solved one contact at a time when the 2x2
+// normal mass is worse conditioned than this
+const float MAX_BLOCK_CONDITION_NUMBER = 1000.0f;
+
+// shortest step step() takes, a zero or negative one would never advance
+const float MIN_TIMESTEP = 1.0f / 10000.0f;
+
+// bodies slower than these for TIME_TO_SLEEP seconds fall asleep
+// 5cm/s and 2 degrees/s
+const float SLEEP_LINEAR_TOLERANCE = 0.05f * PIXELS_PER_METER;
+const float SLEEP_ANGULAR_TOLERANCE = 2.0f / 180.0f * 3.14159265f;
+// in seconds
+const float TIME_TO_SLEEP = 0.5f;
+
 #endif
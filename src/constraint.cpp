@@ -1,52 +1,38 @@
 #include "constraint.h"
 #include "body.h"
-#include "matrix_mn.h"
+#include "constants.h"
+#include "mat.h"
+#include "solver_bodies.h"
 #include "vec2.h"
-#include "vec_n.h"
 #include <algorithm>
-
-VecN Constraint::get_velocities() const {
-    VecN V(6);
-    V.zero();
-    V[0] = a->velocity.x;
-    V[1] = a->velocity.y;
-    V[2] = a->angular_vel;
-    V[3] = b->velocity.x;
-    V[4] = b->velocity.y;
-    V[5] = b->angular_vel;
-
-    return V;
-}
+#include <cmath>
 
 /**
- * Mat6x6 with the all inverse mass and inverse I of bodies a and b
- *  [ 1/ma  0     0     0     0     0     ]
- *  [ 0     1/ma  0     0     0     0     ]
- *  [ 0     0     1/Ia  0     0     0     ]
- *  [ 0     0     0     1/mb  0     0     ]
- *  [ 0     0     0     0     1/mb  0     ]
- *  [ 0     0     0     0     0     1/Ib  ]
+ * Spring-damper of frequency `hertz` solved implicitly over a substep h
+ *  omega = 2 * pi * hertz
+ *  bias_rate = omega / (2 * zeta + h * omega)
+ *  mass_scale = h * omega * (2 * zeta + h * omega) / (1 + ...)
+ *  impulse_scale = 1 / (1 + h * omega * (2 * zeta + h * omega))
  */
-MatrixMN Constraint::get_inv_matrix() const {
-    MatrixMN inv_m(6, 6);
-    inv_m.zero();
-
-    inv_m.rows[0][0] = a->inv_mass;
-    inv_m.rows[1][1] = a->inv_mass;
-    inv_m.rows[2][2] = a->inv_I;
-    inv_m.rows[3][3] = b->inv_mass;
-    inv_m.rows[4][4] = b->inv_mass;
-    inv_m.rows[5][5] = b->inv_I;
+Softness::Softness(float hertz, float damping_ratio, float h) {
+    if (hertz == 0.0f) {
+        return;
+    }
 
-    return inv_m;
+    const float omega = 2.0f * M_PI * hertz;
+    const float a1 = 2.0f * damping_ratio + h * omega;
+    const float a2 = h * omega * a1;
+    const float a3 = 1.0f / (1.0f + a2);
+    bias_rate = omega / a1;
+    mass_scale = a2 * a3;
+    impulse_scale = a3;
 }
 
-JointConstraint::JointConstraint()
-    : Constraint(), jacobian(1, 6), cached_lambda(1), bias(0.0f) {
+JointConstraint::JointConstraint() : Constraint(JOINT), bias(0.0f) {
     cached_lambda.zero();
 }
 JointConstraint::JointConstraint(Body *a, Body *b, const Vec2 &anchor_point)
-    : Constraint(), jacobian(1, 6), cached_lambda(1), bias(0.0f) {
+    : Constraint(JOINT), bias(0.0f) {
     this->a = a;
     this->b = b;
     this->a_point = a->worldspace_to_localspace(anchor_point);
@@ -55,7 +41,10 @@ JointConstraint::JointConstraint(Body *a, Body *b, const Vec2 &anchor_point)
     cached_lambda.zero();
 }
 
-void JointConstraint::pre_solve(const float dt) {
+void JointConstraint::pre_solve(SolverBodies &bodies, const float dt) {
+    index_a = a->solver_index;
+    index_b = b->solver_index;
+
     // get anchor point position in world space
     const Vec2 pa = a->localspace_to_worldspace(a_point);
     const Vec2 pb = b->localspace_to_worldspace(b_point);
@@ -80,14 +69,10 @@ void JointConstraint::pre_solve(const float dt) {
     // Before anything else, apply the cached_lambda from the previous solve()
     // call
     // compute final impulses with direction and magnitude
-    const MatrixMN jt = jacobian.transpose();
-    VecN impulses = jt * cached_lambda;
+    Vec<6> impulses = jacobian.transpose_mul(cached_lambda);
 
     // apply lambda impulse to both A and B
-    a->apply_impulse_linear(Vec2(impulses[0], impulses[1]));
-    a->apply_impulse_angular(impulses[2]);
-    b->apply_impulse_linear(Vec2(impulses[3], impulses[4]));
-    b->apply_impulse_angular(impulses[5]);
+    bodies.apply_impulses(index_a, index_b, impulses);
 
     // compute bias (baumgarte stabilization)
     const float beta = 0.1f;
@@ -97,52 +82,143 @@ void JointConstraint::pre_solve(const float dt) {
     bias = (beta / dt) * C;
 }
 
-void JointConstraint::post_solve() {
+void JointConstraint::post_solve([[maybe_unused]] SolverBodies &bodies) {
     // TODO
 }
 
-void JointConstraint::solve() {
+void JointConstraint::solve(SolverBodies &bodies) {
     // v = get_velocities()
-    const VecN v = get_velocities();
+    const Vec<6> v = bodies.get_velocities(index_a, index_b);
 
     // inv_M = get_invM()
-    const MatrixMN inv_M = get_inv_matrix();
-
-    const MatrixMN jt = jacobian.transpose();
+    const Vec<6> inv_M = bodies.get_inv_matrix(index_a, index_b);
 
     // compute lambda -> impulse to apply to objects A and B
     // lambda = -(JV + b) / (JM^(-1)Jt)
     // (JM^(-1)Jt)lambda = -(JV + b)
-    VecN rhs = jacobian * v * -1.0f;
-    MatrixMN lhs = jacobian * inv_M * jt;
+    Vec<1> rhs = jacobian * v * -1.0f;
+    Mat<1, 1> lhs = jacobian.mul_diagonal_transpose(inv_M);
     rhs[0] -= bias;
     // Solve lambda using the **Gauss-Seidel method**
     // Ax = b
-    VecN lambda = MatrixMN::solve_gauss_seidel(lhs, rhs);
+    Vec<1> lambda = Mat<1, 1>::solve_gauss_seidel(lhs, rhs);
 
     // save the lambda
     cached_lambda += lambda;
 
     // compute final impulses with direction and magnitude
-    VecN impulses = jt * lambda;
+    Vec<6> impulses = jacobian.transpose_mul(lambda);
 
     // apply lambda impulse to both A and B
-    a->apply_impulse_linear(Vec2(impulses[0], impulses[1]));
-    a->apply_impulse_angular(impulses[2]);
-    b->apply_impulse_linear(Vec2(impulses[3], impulses[4]));
-    b->apply_impulse_angular(impulses[5]);
+    bodies.apply_impulses(index_a, index_b, impulses);
+}
+
+void JointConstraint::prepare([[maybe_unused]] SolverBodies &bodies,
+                              const float h) {
+    index_a = a->solver_index;
+    index_b = b->solver_index;
+
+    const Vec2 pa = a->localspace_to_worldspace(a_point);
+    const Vec2 pb = b->localspace_to_worldspace(b_point);
+    ra = pa - a->position;
+    rb = pb - b->position;
+    delta_center = b->position - a->position;
+
+    softness = Softness(JOINT_HERTZ, JOINT_DAMPING_RATIO, h);
+}
+
+void JointConstraint::warm_start(SolverBodies &bodies) {
+    const Vec2 ra_now = bodies.rotate_by_delta(index_a, ra);
+    const Vec2 rb_now = bodies.rotate_by_delta(index_b, rb);
+
+    Vec<6> impulses;
+    impulses[0] = -point_impulse.x;
+    impulses[1] = -point_impulse.y;
+    impulses[2] = -ra_now.cross(point_impulse);
+    impulses[3] = point_impulse.x;
+    impulses[4] = point_impulse.y;
+    impulses[5] = rb_now.cross(point_impulse);
+    bodies.apply_impulses(index_a, index_b, impulses);
+}
+
+/**
+ * Keeps both anchors at the same point, C = pb - pa as a 2D constraint
+ * K = [[ma + mb + Ia * ra.y^2 + Ib * rb.y^2, -Ia * ra.x * ra.y - ...],
+ *      [-Ia * ra.x * ra.y - ..., ma + mb + Ia * ra.x^2 + Ib * rb.x^2]]
+ */
+void JointConstraint::solve_soft(SolverBodies &bodies,
+                                 [[maybe_unused]] const float inv_h,
+                                 bool use_bias) {
+    const float ma = bodies.inv_mass[index_a];
+    const float mb = bodies.inv_mass[index_b];
+    const float ia = bodies.inv_I[index_a];
+    const float ib = bodies.inv_I[index_b];
+
+    const Vec2 ra_now = bodies.rotate_by_delta(index_a, ra);
+    const Vec2 rb_now = bodies.rotate_by_delta(index_b, rb);
+
+    const float wa = bodies.get_angular_vel(index_a);
+    const float wb = bodies.get_angular_vel(index_b);
+    const Vec2 va =
+        bodies.get_velocity(index_a) + Vec2(-wa * ra_now.y, wa * ra_now.x);
+    const Vec2 vb =
+        bodies.get_velocity(index_b) + Vec2(-wb * rb_now.y, wb * rb_now.x);
+    const Vec2 c_dot = vb - va;
+
+    Vec2 bias_vel(0.0f, 0.0f);
+    float mass_scale = 1.0f;
+    float impulse_scale = 0.0f;
+    if (use_bias) {
+        const Vec2 separation = delta_center +
+                                bodies.get_delta_position(index_b) -
+                                bodies.get_delta_position(index_a) + rb_now -
+                                ra_now;
+        bias_vel = separation * softness.bias_rate;
+        mass_scale = softness.mass_scale;
+        impulse_scale = softness.impulse_scale;
+    }
+
+    const float k11 = ma + mb + ia * ra_now.y * ra_now.y +
+                      ib * rb_now.y * rb_now.y;
+    const float k12 =
+        -ia * ra_now.x * ra_now.y - ib * rb_now.x * rb_now.y;
+    const float k22 = ma + mb + ia * ra_now.x * ra_now.x +
+                      ib * rb_now.x * rb_now.x;
+    float det = k11 * k22 - k12 * k12;
+    if (det != 0.0f) {
+        det = 1.0f / det;
+    }
+    const Vec2 rhs = c_dot + bias_vel;
+    const Vec2 solved(det * (k22 * rhs.x - k12 * rhs.y),
+                      det * (k11 * rhs.y - k12 * rhs.x));
+
+    const Vec2 impulse = solved * -mass_scale - point_impulse * impulse_scale;
+    point_impulse += impulse;
+
+    Vec<6> impulses;
+    impulses[0] = -impulse.x;
+    impulses[1] = -impulse.y;
+    impulses[2] = -ra_now.cross(impulse);
+    impulses[3] = impulse.x;
+    impulses[4] = impulse.y;
+    impulses[5] = rb_now.cross(impulse);
+    bodies.apply_impulses(index_a, index_b, impulses);
+}
+
+void JointConstraint::apply_restitution([[maybe_unused]] SolverBodies &bodies) {
+    // joints don't bounce
 }
 
 PenetrationConstraint::PenetrationConstraint()
-    : Constraint(), jacobian(2, 6), cached_lambda(2), bias(0.0f) {
+    : Constraint(PENETRATION), bias(0.0f), contact_id(0) {
     cached_lambda.zero();
     friction = 0.0f;
 }
 PenetrationConstraint::PenetrationConstraint(Body *a, Body *b,
                                              const Vec2 &a_collision_point,
                                              const Vec2 &b_collision_point,
-                                             const Vec2 &normal)
-    : Constraint(), jacobian(2, 6), cached_lambda(2), bias(0.0f) {
+                                             const Vec2 &normal, int contact_id)
+    : Constraint(PENETRATION), bias(0.0f), contact_id(contact_id) {
     this->a = a;
     this->b = b;
     this->a_point = a->worldspace_to_localspace(a_collision_point);
@@ -153,11 +229,64 @@ PenetrationConstraint::PenetrationConstraint(Body *a, Body *b,
     friction = 0.0f;
 }
 
+void PenetrationConstraint::warm_start_from(const Vec<2> &previous_lambda) {
+    cached_lambda = previous_lambda;
+}
+
+const Vec<2> &PenetrationConstraint::get_cached_lambda() const {
+    return cached_lambda;
+}
+
+const Mat<2, 6> &PenetrationConstraint::get_jacobian() const {
+    return jacobian;
+}
+
+float PenetrationConstraint::get_bias() const { return bias; }
+
+float PenetrationConstraint::get_friction() const { return friction; }
+
+void PenetrationConstraint::solve_tangent(SolverBodies &bodies) {
+    if (friction <= 0.0) {
+        return;
+    }
+
+    const Vec<6> v = bodies.get_velocities(index_a, index_b);
+    const Vec<6> inv_M = bodies.get_inv_matrix(index_a, index_b);
+    const Vec<6> &tangent = jacobian.rows[1];
+
+    float k_tangent = 0.0f;
+    for (int i = 0; i < 6; i++) {
+        k_tangent += tangent[i] * inv_M[i] * tangent[i];
+    }
+    if (k_tangent == 0.0f) {
+        return;
+    }
+
+    const float old_tangent = cached_lambda[1];
+    const float max_friction = cached_lambda[0] * friction;
+    cached_lambda[1] = std::clamp(old_tangent - tangent.dot(v) / k_tangent,
+                                  -max_friction, max_friction);
+
+    const Vec<6> impulses = tangent * (cached_lambda[1] - old_tangent);
+    bodies.apply_impulses(index_a, index_b, impulses);
+}
+
+void PenetrationConstraint::add_normal_impulse(SolverBodies &bodies,
+                                               float lambda) {
+    cached_lambda[0] += lambda;
+    const Vec<6> impulses = jacobian.rows[0] * lambda;
+    bodies.apply_impulses(index_a, index_b, impulses);
+}
+
 /**
  * C = [[-n, -ra X n, n, rb X n], [-t, -ra X t, t, rb X t]] * [[va], [wa], [vb],
  * [wb]]
  */
-void PenetrationConstraint::pre_solve(const float dt) {
+void PenetrationConstraint::pre_solve(SolverBodies &bodies,
+                                      const float dt) {
+    index_a = a->solver_index;
+    index_b = b->solver_index;
+
     // get collision points in world space
     const Vec2 pa = a->localspace_to_worldspace(a_point);
     const Vec2 pb = b->localspace_to_worldspace(b_point);
@@ -197,58 +326,71 @@ void PenetrationConstraint::pre_solve(const float dt) {
         jacobian.rows[1][5] = rb.cross(t);
     }
 
-    // Warm starting
-    // Before anything else, apply the cached_lambda from the previous solve()
-    // call
-    // compute final impulses with direction and magnitude
-    const MatrixMN jt = jacobian.transpose();
-    VecN impulses = jt * cached_lambda;
-
-    // apply lambda impulse to both A and B
-    a->apply_impulse_linear(Vec2(impulses[0], impulses[1]));
-    a->apply_impulse_angular(impulses[2]);
-    b->apply_impulse_linear(Vec2(impulses[3], impulses[4]));
-    b->apply_impulse_angular(impulses[5]);
-
     // compute bias (baumgarte stabilization)
     const float beta = 0.2f;
     // compute the positional error
-    float C = (pb - pa).dot(-n);
-    C = std::min(0.0f, C + 0.001f);
+    // positive for speculative contacts, the gap between the bodies
+    const float separation = (pb - pa).dot(-n);
+    const float C = std::min(0.0f, separation + LINEAR_SLOP);
 
     // calculate relative velocity pre-impulse normal to compute elasticity
-    Vec2 va = a->velocity + Vec2(-a->angular_vel * ra.y, a->angular_vel * ra.x);
-    Vec2 vb = b->velocity + Vec2(-b->angular_vel * rb.y, b->angular_vel * rb.x);
+    // it has to come from before any warm starting: the constraints warm
+    // started earlier in this pass have already changed the solver's
+    // velocities, and a stack would see the push of the contact below as an
+    // approach and bounce off it. The bodies still hold the velocities from
+    // before solving.
+    const float wa = a->angular_vel;
+    const float wb = b->angular_vel;
+    Vec2 va = a->velocity + Vec2(-wa * ra.y, wa * ra.x);
+    Vec2 vb = b->velocity + Vec2(-wb * rb.y, wb * rb.x);
     float v_rel_dot_normal = (va - vb).dot(n);
 
     // restitution between two bodies
+    // resting contacts only approach at about g * dt per frame; bouncing
+    // them every frame keeps stacks rocking, so slow contacts don't bounce
     float e = std::min(a->restitution, b->restitution);
+    if (v_rel_dot_normal < RESTITUTION_THRESHOLD) {
+        e = 0.0f;
+    }
 
     // considering elasticity
-    bias = (beta / dt) * C + (e * v_rel_dot_normal);
+    // the solver drives J * v to -bias, so bouncing back at e times the
+    // approach speed takes a negative term, like the positional error
+    bias = (beta / dt) * C - (e * v_rel_dot_normal);
+    if (separation > 0.0f) {
+        // not touching yet, only slow the approach down to closing the gap
+        // within this step, without bouncing
+        bias = separation / dt;
+    }
+
+    // Warm starting
+    // apply the cached_lambda accumulated for this contact last frame
+    // compute final impulses with direction and magnitude
+    Vec<6> impulses = jacobian.transpose_mul(cached_lambda);
+
+    // apply lambda impulse to both A and B
+    bodies.apply_impulses(index_a, index_b, impulses);
 }
 
-void PenetrationConstraint::solve() {
+void PenetrationConstraint::solve(SolverBodies &bodies) {
     // v = get_velocities()
-    const VecN v = get_velocities();
+    const Vec<6> v = bodies.get_velocities(index_a, index_b);
 
     // inv_M = get_invM()
-    const MatrixMN inv_M = get_inv_matrix();
-
-    const MatrixMN jt = jacobian.transpose();
+    const Vec<6> inv_M = bodies.get_inv_matrix(index_a, index_b);
 
     // compute lambda -> impulse to apply to objects A and B
     // lambda = -(JV + b) / (JM^(-1)Jt)
     // (JM^(-1)Jt)lambda = -(JV + b)
-    VecN rhs = jacobian * v * -1.0f;
-    MatrixMN lhs = jacobian * inv_M * jt;
+    Vec<2> rhs = jacobian * v * -1.0f;
+    Mat<2, 2> lhs = jacobian.mul_diagonal_transpose(inv_M);
     rhs[0] -= bias;
     // Solve lambda using the **Gauss-Seidel method**
     // Ax = b
-    VecN lambda = MatrixMN::solve_gauss_seidel(lhs, rhs);
+    Vec<2> lambda = Mat<2, 2>::solve_gauss_seidel(lhs, rhs);
     // think about the sign of the lambda, because we want to _accumulate_
     // save a temp lambda
-    VecN old_lambda = cached_lambda;
+    Vec<2> old_lambda = cached_lambda;
     // save the lambda
     cached_lambda += lambda;
     cached_lambda[0] = (cached_lambda[0] < 0.0f) ? 0.0f : cached_lambda[0];
@@ -263,15 +405,305 @@ void PenetrationConstraint::solve() {
     lambda = cached_lambda - old_lambda;
 
     // compute final impulses with direction and magnitude
-    VecN impulses = jt * lambda;
+    Vec<6> impulses = jacobian.transpose_mul(lambda);
 
     // apply lambda impulse to both A and B
-    a->apply_impulse_linear(Vec2(impulses[0], impulses[1]));
-    a->apply_impulse_angular(impulses[2]);
-    b->apply_impulse_linear(Vec2(impulses[3], impulses[4]));
-    b->apply_impulse_angular(impulses[5]);
+    bodies.apply_impulses(index_a, index_b, impulses);
 }
 
-void PenetrationConstraint::post_solve() {
+void PenetrationConstraint::post_solve(
+    [[maybe_unused]] SolverBodies &bodies) {
     // TODO
 }
+
+void PenetrationConstraint::prepare(SolverBodies &bodies, const float h) {
+    index_a = a->solver_index;
+    index_b = b->solver_index;
+
+    const Vec2 pa = a->localspace_to_worldspace(a_point);
+    const Vec2 pb = b->localspace_to_worldspace(b_point);
+    const Vec2 n = a->localspace_to_worldspace(normal);
+    world_normal = n;
+    ra = pa - a->position;
+    rb = pb - b->position;
+
+    // same positional error as pre_solve(), negative while overlapping
+    // it grows with (vb - va).n, so it's tracked as the anchors move
+    // through the substeps
+    const float C = -(pb - pa).dot(n);
+    adjusted_separation = C - (rb - ra).dot(n);
+
+    const float ma = bodies.inv_mass[index_a];
+    const float mb = bodies.inv_mass[index_b];
+    const float ia = bodies.inv_I[index_a];
+    const float ib = bodies.inv_I[index_b];
+
+    const float rn_a = ra.cross(n);
+    const float rn_b = rb.cross(n);
+    const float k_normal = ma + mb + ia * rn_a * rn_a + ib * rn_b * rn_b;
+    normal_mass = k_normal > 0.0f ? 1.0f / k_normal : 0.0f;
+
+    const Vec2 t = n.normal();
+    const float rt_a = ra.cross(t);
+    const float rt_b = rb.cross(t);
+    const float k_tangent = ma + mb + ia * rt_a * rt_a + ib * rt_b * rt_b;
+    tangent_mass = k_tangent > 0.0f ? 1.0f / k_tangent : 0.0f;
+
+    friction = std::max(a->friction, b->friction);
+    restitution = std::min(a->restitution, b->restitution);
+
+    const float wa = bodies.get_angular_vel(index_a);
+    const float wb = bodies.get_angular_vel(index_b);
+    const Vec2 va = bodies.get_velocity(index_a) + Vec2(-wa * ra.y, wa * ra.x);
+    const Vec2 vb = bodies.get_velocity(index_b) + Vec2(-wb * rb.y, wb * rb.x);
+    relative_velocity = (vb - va).dot(n);
+    max_normal_impulse = 0.0f;
+
+    // no stiffer than a quarter of the substep rate, or it overshoots
+    const float hertz = std::min(CONTACT_HERTZ, 0.25f / h);
+    softness = Softness(hertz, CONTACT_DAMPING_RATIO, h);
+}
+
+void PenetrationConstraint::warm_start(SolverBodies &bodies) {
+    const Vec2 t = world_normal.normal();
+    const Vec2 p = world_normal * cached_lambda[0] + t * cached_lambda[1];
+
+    Vec<6> impulses;
+    impulses[0] = -p.x;
+    impulses[1] = -p.y;
+    impulses[2] = -ra.cross(p);
+    impulses[3] = p.x;
+    impulses[4] = p.y;
+    impulses[5] = rb.cross(p);
+    bodies.apply_impulses(index_a, index_b, impulses);
+}
+
+void PenetrationConstraint::solve_soft(SolverBodies &bodies,
+                                       const float inv_h, bool use_bias) {
+    const Vec2 n = world_normal;
+
+    // current separation from how far the bodies moved in this step
+    const Vec2 ra_now = bodies.rotate_by_delta(index_a, ra);
+    const Vec2 rb_now = bodies.rotate_by_delta(index_b, rb);
+    const Vec2 d = bodies.get_delta_position(index_b) -
+                   bodies.get_delta_position(index_a) + rb_now - ra_now;
+    const float separation = d.dot(n) + adjusted_separation;
+
+    float bias = 0.0f;
+    float mass_scale = 1.0f;
+    float impulse_scale = 0.0f;
+    if (separation > 0.0f) {
+        // not touching yet, only remove the velocity that would close the gap
+        bias = separation * inv_h;
+    } else if (use_bias) {
+        bias = std::max(softness.bias_rate * separation,
+                        -MAX_CONTACT_PUSH_VELOCITY);
+        mass_scale = softness.mass_scale;
+        impulse_scale = softness.impulse_scale;
+    }
+
+    // normal
+    float wa = bodies.get_angular_vel(index_a);
+    float wb = bodies.get_angular_vel(index_b);
+    Vec2 va = bodies.get_velocity(index_a) + Vec2(-wa * ra.y, wa * ra.x);
+    Vec2 vb = bodies.get_velocity(index_b) + Vec2(-wb * rb.y, wb * rb.x);
+    const float vn = (vb - va).dot(n);
+
+    float lambda = -normal_mass * mass_scale * (vn + bias) -
+                   impulse_scale * cached_lambda[0];
+    const float old_normal = cached_lambda[0];
+    cached_lambda[0] = std::max(old_normal + lambda, 0.0f);
+    lambda = cached_lambda[0] - old_normal;
+    max_normal_impulse = std::max(max_normal_impulse, lambda);
+
+    Vec<6> impulses;
+    impulses[0] = -n.x * lambda;
+    impulses[1] = -n.y * lambda;
+    impulses[2] = -ra.cross(n) * lambda;
+    impulses[3] = n.x * lambda;
+    impulses[4] = n.y * lambda;
+    impulses[5] = rb.cross(n) * lambda;
+    bodies.apply_impulses(index_a, index_b, impulses);
+
+    // friction, keep it between -(λn*μ) and (λn*μ)
+    if (friction > 0.0) {
+        const Vec2 t = n.normal();
+        wa = bodies.get_angular_vel(index_a);
+        wb = bodies.get_angular_vel(index_b);
+        va = bodies.get_velocity(index_a) + Vec2(-wa * ra.y, wa * ra.x);
+        vb = bodies.get_velocity(index_b) + Vec2(-wb * rb.y, wb * rb.x);
+        const float vt = (vb - va).dot(t);
+
+        const float max_friction = cached_lambda[0] * friction;
+        const float old_tangent = cached_lambda[1];
+        cached_lambda[1] = std::clamp(old_tangent - tangent_mass * vt,
+                                      -max_friction, max_friction);
+        const float lambda_t = cached_lambda[1] - old_tangent;
+
+        impulses[0] = -t.x * lambda_t;
+        impulses[1] = -t.y * lambda_t;
+        impulses[2] = -ra.cross(t) * lambda_t;
+        impulses[3] = t.x * lambda_t;
+        impulses[4] = t.y * lambda_t;
+        impulses[5] = rb.cross(t) * lambda_t;
+        bodies.apply_impulses(index_a, index_b, impulses);
+    }
+}
+
+/**
+ * Bounce once at the end of the step, from the approach velocity measured
+ * before solving, so substeps and relaxing don't eat the restitution
+ */
+void PenetrationConstraint::apply_restitution(SolverBodies &bodies) {
+    if (restitution == 0.0f || max_normal_impulse == 0.0f ||
+        relative_velocity > -RESTITUTION_THRESHOLD) {
+        return;
+    }
+
+    const Vec2 n = world_normal;
+    const float wa = bodies.get_angular_vel(index_a);
+    const float wb = bodies.get_angular_vel(index_b);
+    const Vec2 va = bodies.get_velocity(index_a) + Vec2(-wa * ra.y, wa * ra.x);
+    const Vec2 vb = bodies.get_velocity(index_b) + Vec2(-wb * rb.y, wb * rb.x);
+    const float vn = (vb - va).dot(n);
+
+    float lambda = -normal_mass * (vn + restitution * relative_velocity);
+    const float old_normal = cached_lambda[0];
+    cached_lambda[0] = std::max(old_normal + lambda, 0.0f);
+    lambda = cached_lambda[0] - old_normal;
+
+    Vec<6> impulses;
+    impulses[0] = -n.x * lambda;
+    impulses[1] = -n.y * lambda;
+    impulses[2] = -ra.cross(n) * lambda;
+    impulses[3] = n.x * lambda;
+    impulses[4] = n.y * lambda;
+    impulses[5] = rb.cross(n) * lambda;
+    bodies.apply_impulses(index_a, index_b, impulses);
+}
+
+ManifoldConstraint::ManifoldConstraint(PenetrationConstraint *first,
+                                       PenetrationConstraint *second)
+    : Constraint(MANIFOLD) {
+    this->a = first->a;
+    this->b = first->b;
+    points[0] = first;
+    points[1] = second;
+}
+
+void ManifoldConstraint::pre_solve(SolverBodies &bodies, const float dt) {
+    index_a = a->solver_index;
+    index_b = b->solver_index;
+    points[0]->pre_solve(bodies, dt);
+    points[1]->pre_solve(bodies, dt);
+
+    Mat<2, 6> normals;
+    normals.rows[0] = points[0]->get_jacobian().rows[0];
+    normals.rows[1] = points[1]->get_jacobian().rows[0];
+    normal_mass =
+        normals.mul_diagonal_transpose(bodies.get_inv_matrix(index_a, index_b));
+
+    const float k11 = normal_mass.rows[0][0];
+    const float k12 = normal_mass.rows[0][1];
+    const float k22 = normal_mass.rows[1][1];
+    const float det = k11 * k22 - k12 * k12;
+    use_block = k11 * k11 < MAX_BLOCK_CONDITION_NUMBER * det;
+    if (use_block) {
+        const float inv_det = 1.0f / det;
+        inv_normal_mass.rows[0][0] = k22 * inv_det;
+        inv_normal_mass.rows[0][1] = -k12 * inv_det;
+        inv_normal_mass.rows[1][0] = -k12 * inv_det;
+        inv_normal_mass.rows[1][1] = k11 * inv_det;
+    }
+}
+
+/**
+ * Total normal impulses x >= 0 with K * x + b = vn >= 0 and x * vn = 0
+ * Tries both contacts pushing, then either one alone, then none. Returns
+ * false when no case fits, which only rounding errors cause.
+ */
+static bool solve_block(const Mat<2, 2> &k, const Mat<2, 2> &inv_k,
+                        const Vec<2> &b, Vec<2> &x) {
+    // both pushing, both normal velocities at their target
+    x = inv_k * b * -1.0f;
+    if (x[0] >= 0.0f && x[1] >= 0.0f) {
+        return true;
+    }
+
+    // only the first one pushing, the second one separating
+    x[0] = -b[0] / k.rows[0][0];
+    x[1] = 0.0f;
+    if (x[0] >= 0.0f && k.rows[1][0] * x[0] + b[1] >= 0.0f) {
+        return true;
+    }
+
+    // only the second one pushing
+    x[0] = 0.0f;
+    x[1] = -b[1] / k.rows[1][1];
+    if (x[1] >= 0.0f && k.rows[0][1] * x[1] + b[0] >= 0.0f) {
+        return true;
+    }
+
+    // both separating
+    x.zero();
+    return b[0] >= 0.0f && b[1] >= 0.0f;
+}
+
+void ManifoldConstraint::solve(SolverBodies &bodies) {
+    if (!use_block) {
+        points[0]->solve(bodies);
+        points[1]->solve(bodies);
+        return;
+    }
+
+    // friction first, bounded by the normal impulses of the last iteration
+    points[0]->solve_tangent(bodies);
+    points[1]->solve_tangent(bodies);
+
+    // with the accumulated impulses a, K * (x - a) changes the normal
+    // velocities J * v + bias into K * x + b
+    const Vec<6> v = bodies.get_velocities(index_a, index_b);
+    Vec<2> accumulated;
+    Vec<2> b;
+    for (int i = 0; i < 2; i++) {
+        accumulated[i] = points[i]->get_cached_lambda()[0];
+        b[i] = points[i]->get_jacobian().rows[0].dot(v) +
+               points[i]->get_bias();
+    }
+    b -= normal_mass * accumulated;
+
+    Vec<2> x;
+    if (!solve_block(normal_mass, inv_normal_mass, b, x)) {
+        return;
+    }
+    points[0]->add_normal_impulse(bodies, x[0] - accumulated[0]);
+    points[1]->add_normal_impulse(bodies, x[1] - accumulated[1]);
+}
+
+void ManifoldConstraint::post_solve(SolverBodies &bodies) {
+    points[0]->post_solve(bodies);
+    points[1]->post_solve(bodies);
+}
+
+void ManifoldConstraint::prepare(SolverBodies &bodies, const float h) {
+    index_a = a->solver_index;
+    index_b = b->solver_index;
+    points[0]->prepare(bodies, h);
+    points[1]->prepare(bodies, h);
+}
+
+void ManifoldConstraint::warm_start(SolverBodies &bodies) {
+    points[0]->warm_start(bodies);
+    points[1]->warm_start(bodies);
+}
+
+void ManifoldConstraint::solve_soft(SolverBodies &bodies, const float inv_h,
+                                    bool use_bias) {
+    points[0]->solve_soft(bodies, inv_h, use_bias);
+    points[1]->solve_soft(bodies, inv_h, use_bias);
+}
+
+void ManifoldConstraint::apply_restitution(SolverBodies &bodies) {
+    points[0]->apply_restitution(bodies);
+    points[1]->apply_restitution(bodies);
+}
@@ -2,12 +2,34 @@
 #define CONSTRAINT_H
 
 #include "body.h"
-#include "matrix_mn.h"
+#include "mat.h"
+#include "solver_bodies.h"
 #include "vec2.h"
-#include "vec_n.h"
 
+/**
+ * Spring and damper of a soft constraint, for one substep of length h
+ * The soft step solver uses these instead of a Baumgarte bias, see
+ * World::SOFT_STEP.
+ * Rigid (no softness): bias_rate 0, mass_scale 1, impulse_scale 0
+ */
+struct Softness {
+    float bias_rate = 0.0f;
+    float mass_scale = 1.0f;
+    float impulse_scale = 0.0f;
+
+    Softness() = default;
+    Softness(float hertz, float damping_ratio, float h);
+};
+
+enum ConstraintType { JOINT, PENETRATION, MANIFOLD };
+
+/**
+ * The solver goes through the virtual calls, the type tag lets the SIMD
+ * contact solver pick out the contacts without RTTI
+ */
 class Constraint {
   public:
+    ConstraintType type;
     Body *a;
     Body *b;
 
@@ -16,37 +38,69 @@ class Constraint {
     // anchor point in B's local space
     Vec2 b_point;
 
+    Constraint(ConstraintType type) : type(type) {}
     virtual ~Constraint() = default;
 
-    MatrixMN get_inv_matrix() const;
-    VecN get_velocities() const;
+    // slots of a and b in the SolverBodies, set by pre_solve()
+    int index_a = -1;
+    int index_b = -1;
 
     // the `{}` is needed here
     // otherwise you will get the `undefined reference to vtable` error!
     // https://gcc.gnu.org/faq.html#vtables
-    virtual void solve() {};
-    virtual void pre_solve([[maybe_unused]] const float dt) {};
-    virtual void post_solve() {};
+    // solve() only works on the SolverBodies, pre_solve() may also read the
+    // positions of a and b
+    virtual void solve([[maybe_unused]] SolverBodies &bodies) {};
+    virtual void pre_solve([[maybe_unused]] SolverBodies &bodies,
+                           [[maybe_unused]] const float dt) {};
+    virtual void post_solve([[maybe_unused]] SolverBodies &bodies) {};
+
+    // soft step solver, prepare() runs once per step with the substep
+    // length h, warm_start() and solve_soft() in every substep and
+    // apply_restitution() once at the end
+    // solve_soft() without bias is the relax pass
+    virtual void prepare([[maybe_unused]] SolverBodies &bodies,
+                         [[maybe_unused]] const float h) {};
+    virtual void warm_start([[maybe_unused]] SolverBodies &bodies) {};
+    virtual void solve_soft([[maybe_unused]] SolverBodies &bodies,
+                            [[maybe_unused]] const float inv_h,
+                            [[maybe_unused]] bool use_bias) {};
+    virtual void apply_restitution([[maybe_unused]] SolverBodies &bodies) {};
 };
 
 class JointConstraint : public Constraint {
   private:
-    MatrixMN jacobian;
-    VecN cached_lambda;
+    Mat<1, 6> jacobian;
+    Vec<1> cached_lambda;
     float bias;
 
+    // soft step: the anchors relative to the centers and the distance
+    // between the centers at the start of the step
+    Vec2 ra;
+    Vec2 rb;
+    Vec2 delta_center;
+    // accumulated impulse keeping the anchors together
+    Vec2 point_impulse;
+    Softness softness;
+
   public:
     JointConstraint();
     JointConstraint(Body *a, Body *b, const Vec2 &anchor_point);
-    void solve() override;
-    void pre_solve(const float dt) override;
-    void post_solve() override;
+    void solve(SolverBodies &bodies) override;
+    void pre_solve(SolverBodies &bodies, const float dt) override;
+    void post_solve(SolverBodies &bodies) override;
+
+    void prepare(SolverBodies &bodies, const float h) override;
+    void warm_start(SolverBodies &bodies) override;
+    void solve_soft(SolverBodies &bodies, const float inv_h,
+                    bool use_bias) override;
+    void apply_restitution(SolverBodies &bodies) override;
 };
 
 class PenetrationConstraint : public Constraint {
   private:
-    MatrixMN jacobian;
-    VecN cached_lambda;
+    Mat<2, 6> jacobian;
+    Vec<2> cached_lambda;
     float bias;
 
     // normal direction of the penetration in A's local space
@@ -54,13 +108,79 @@ class PenetrationConstraint : public Constraint {
     // friction coefficient between the two penetrating bodies
     float friction;
 
+    // soft step: world space normal and anchors at the start of the step
+    Vec2 world_normal;
+    Vec2 ra;
+    Vec2 rb;
+    // separation minus the part that changes as the anchors move
+    float adjusted_separation;
+    float normal_mass;
+    float tangent_mass;
+    // normal velocity before solving, for restitution
+    float relative_velocity;
+    float max_normal_impulse;
+    float restitution;
+    Softness softness;
+
   public:
+    // id of the contact this constraint was built from, see Contact::id
+    int contact_id;
+
     PenetrationConstraint();
     PenetrationConstraint(Body *a, Body *b, const Vec2 &a_collision_point,
-                          const Vec2 &b_collision_point, const Vec2 &normal);
-    void solve() override;
-    void pre_solve(const float dt) override;
-    void post_solve() override;
+                          const Vec2 &b_collision_point, const Vec2 &normal,
+                          int contact_id);
+    // start from the normal and friction impulses accumulated last frame
+    void warm_start_from(const Vec<2> &previous_lambda);
+    const Vec<2> &get_cached_lambda() const;
+    // set up by pre_solve(), for solving several contacts at once
+    const Mat<2, 6> &get_jacobian() const;
+    float get_bias() const;
+    float get_friction() const;
+    // the friction row alone, bounded by the normal impulse so far
+    void solve_tangent(SolverBodies &bodies);
+    // add lambda to the normal impulse and apply it
+    void add_normal_impulse(SolverBodies &bodies, float lambda);
+    void solve(SolverBodies &bodies) override;
+    void pre_solve(SolverBodies &bodies, const float dt) override;
+    void post_solve(SolverBodies &bodies) override;
+
+    void prepare(SolverBodies &bodies, const float h) override;
+    void warm_start(SolverBodies &bodies) override;
+    void solve_soft(SolverBodies &bodies, const float inv_h,
+                    bool use_bias) override;
+    void apply_restitution(SolverBodies &bodies) override;
+};
+
+/**
+ * Both contacts of a face to face manifold, whose normal impulses the
+ * Baumgarte solver finds together as a 2x2 LCP instead of one after the
+ * other, so resting boxes stop rocking in fewer iterations
+ * Falls back to solving the contacts one by one when the two normal rows
+ * are close to parallel. Only the Baumgarte solver uses it, everything
+ * else is passed on to the contacts.
+ */
+class ManifoldConstraint : public Constraint {
+  private:
+    PenetrationConstraint *points[2] = {nullptr, nullptr};
+    // J * M^-1 * Jt of the two normal rows, and its inverse
+    Mat<2, 2> normal_mass;
+    Mat<2, 2> inv_normal_mass;
+    bool use_block = false;
+
+  public:
+    ManifoldConstraint() : Constraint(MANIFOLD) {}
+    ManifoldConstraint(PenetrationConstraint *first,
+                       PenetrationConstraint *second);
+    void solve(SolverBodies &bodies) override;
+    void pre_solve(SolverBodies &bodies, const float dt) override;
+    void post_solve(SolverBodies &bodies) override;
+
+    void prepare(SolverBodies &bodies, const float h) override;
+    void warm_start(SolverBodies &bodies) override;
+    void solve_soft(SolverBodies &bodies, const float inv_h,
+                    bool use_bias) override;
+    void apply_restitution(SolverBodies &bodies) override;
 };
 
 #endif
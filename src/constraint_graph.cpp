@@ -0,0 +1,62 @@
+#include "constraint_graph.h"
+#include "constraint.h"
+#include "solver_bodies.h"
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+void ConstraintGraph::build(const std::vector<Constraint *> &constraints,
+                            const SolverBodies &bodies) {
+    body_colors.assign(bodies.inv_mass.size(), 0);
+    for (int i = 0; i < num_colors; i++) {
+        colors[i].clear();
+    }
+    overflow.clear();
+    num_colors = 0;
+
+    for (auto constraint : constraints) {
+        const int index_a = constraint->a->solver_index;
+        const int index_b = constraint->b->solver_index;
+        const bool static_a = bodies.inv_mass[index_a] == 0.0f;
+        const bool static_b = bodies.inv_mass[index_b] == 0.0f;
+
+        uint64_t used = 0;
+        if (!static_a) {
+            used |= body_colors[index_a];
+        }
+        if (!static_b) {
+            used |= body_colors[index_b];
+        }
+        if (used == ~(uint64_t)0) {
+            overflow.push_back(constraint);
+            continue;
+        }
+
+        // lowest colour neither body is in yet
+        const int color = std::countr_one(used);
+        if (!static_a) {
+            body_colors[index_a] |= (uint64_t)1 << color;
+        }
+        if (!static_b) {
+            body_colors[index_b] |= (uint64_t)1 << color;
+        }
+
+        if (color >= (int)colors.size()) {
+            colors.resize(color + 1);
+        }
+        if (color >= num_colors) {
+            num_colors = color + 1;
+        }
+        colors[color].push_back(constraint);
+    }
+}
+
+int ConstraintGraph::get_num_colors() const { return num_colors; }
+
+const std::vector<Constraint *> &ConstraintGraph::get_color(int color) const {
+    return colors[color];
+}
+
+const std::vector<Constraint *> &ConstraintGraph::get_overflow() const {
+    return overflow;
+}
@@ -0,0 +1,37 @@
+#ifndef CONSTRAINT_GRAPH_H
+#define CONSTRAINT_GRAPH_H
+
+#include "constraint.h"
+#include "solver_bodies.h"
+#include <cstdint>
+#include <vector>
+
+/**
+ * Greedy colouring of the constraint graph
+ * Constraints of the same colour share no dynamic body, so each colour can
+ * be solved in parallel without two threads writing the same velocity.
+ * Static bodies are never written by the solver and don't create conflicts.
+ * Colours are assigned in constraint order, so the result only depends on
+ * the input.
+ */
+class ConstraintGraph {
+  private:
+    // one bit per colour already used by each solver body
+    std::vector<uint64_t> body_colors;
+    std::vector<std::vector<Constraint *>> colors;
+    // constraints that didn't fit in any colour, solved on one thread
+    std::vector<Constraint *> overflow;
+    int num_colors = 0;
+
+  public:
+    static const int MAX_COLORS = 64;
+
+    void build(const std::vector<Constraint *> &constraints,
+               const SolverBodies &bodies);
+
+    int get_num_colors() const;
+    const std::vector<Constraint *> &get_color(int color) const;
+    const std::vector<Constraint *> &get_overflow() const;
+};
+
+#endif
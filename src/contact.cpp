@@ -15,8 +15,8 @@ void Contact::resolve_penetration() {
     a->position -= normal * da;
     b->position += normal * db;
 
-    a->shape->update_vertices(a->rotation, a->position);
-    b->shape->update_vertices(b->rotation, b->position);
+    a->update_transform();
+    b->update_transform();
 }
 
 void Contact::resolve_collision() {
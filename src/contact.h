@@ -14,6 +14,11 @@ struct Contact {
     Vec2 normal;
     float depth;
 
+    // which features of the two shapes produced this contact
+    // stays the same between frames while the bodies keep touching the same
+    // way, so the solver can carry impulses over
+    int id = 0;
+
     // Contact() = default;
     // ~Contact() = default;
 
@@ -0,0 +1,283 @@
+#include "contact_solver.h"
+#include "constraint.h"
+#include "constraint_graph.h"
+#include "frame_arena.h"
+#include "mat.h"
+#include "solver_bodies.h"
+#include <algorithm>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+bool ContactSolver::is_available() {
+#if defined(__SSE2__)
+    return true;
+#else
+    return false;
+#endif
+}
+
+void ContactSolver::build(const ConstraintGraph &graph,
+                          const SolverBodies &bodies, FrameArena &arena) {
+    const int width = ContactBatch::WIDTH;
+
+    num_colors = graph.get_num_colors();
+    if ((int)colors.size() < num_colors) {
+        colors.resize(num_colors);
+    }
+
+    for (int c = 0; c < num_colors; c++) {
+        Color &color = colors[c];
+        color.rest.clear();
+        contacts.clear();
+        for (auto constraint : graph.get_color(c)) {
+            if (constraint->type == PENETRATION) {
+                contacts.push_back(
+                    static_cast<PenetrationConstraint *>(constraint));
+            } else {
+                color.rest.push_back(constraint);
+            }
+        }
+
+        color.num_batches = (int)contacts.size() / width;
+        color.batches = arena.allocate<ContactBatch>(color.num_batches);
+        for (int i = 0; i < color.num_batches; i++) {
+            ContactBatch &batch = color.batches[i];
+            for (int lane = 0; lane < width; lane++) {
+                PenetrationConstraint *contact = contacts[i * width + lane];
+                const int a = contact->index_a;
+                const int b = contact->index_b;
+                const Mat<2, 6> &jacobian = contact->get_jacobian();
+                const Mat<2, 2> lhs = jacobian.mul_diagonal_transpose(
+                    bodies.get_inv_matrix(a, b));
+
+                for (int r = 0; r < 2; r++) {
+                    for (int k = 0; k < 6; k++) {
+                        batch.jacobian[r][k][lane] = jacobian.rows[r][k];
+                    }
+                    batch.lhs[r][0][lane] = lhs.rows[r][0];
+                    batch.lhs[r][1][lane] = lhs.rows[r][1];
+                    batch.lambda[r][lane] = contact->get_cached_lambda()[r];
+                }
+                batch.bias[lane] = contact->get_bias();
+                batch.friction[lane] = contact->get_friction();
+                batch.inv_mass_a[lane] = bodies.inv_mass[a];
+                batch.inv_I_a[lane] = bodies.inv_I[a];
+                batch.inv_mass_b[lane] = bodies.inv_mass[b];
+                batch.inv_I_b[lane] = bodies.inv_I[b];
+                batch.index_a[lane] = a;
+                batch.index_b[lane] = b;
+                batch.constraints[lane] = contact;
+            }
+        }
+
+        // not enough for another batch
+        for (int i = color.num_batches * width; i < (int)contacts.size();
+             i++) {
+            color.rest.push_back(contacts[i]);
+        }
+    }
+}
+
+int ContactSolver::get_num_colors() const { return num_colors; }
+
+const ContactSolver::Color &ContactSolver::get_color(int color) const {
+    return colors[color];
+}
+
+// [vax, vay, wa, vbx, vby, wb] of every lane
+static void load_velocities(const ContactBatch &batch,
+                            const SolverBodies &bodies,
+                            float v[6][ContactBatch::WIDTH]) {
+    for (int lane = 0; lane < ContactBatch::WIDTH; lane++) {
+        const int a = batch.index_a[lane];
+        const int b = batch.index_b[lane];
+        v[0][lane] = bodies.vx[a];
+        v[1][lane] = bodies.vy[a];
+        v[2][lane] = bodies.w[a];
+        v[3][lane] = bodies.vx[b];
+        v[4][lane] = bodies.vy[b];
+        v[5][lane] = bodies.w[b];
+    }
+}
+
+// same as SolverBodies::apply_impulses(), static bodies are never written
+static void apply_impulses(const ContactBatch &batch,
+                           const float impulses[6][ContactBatch::WIDTH],
+                           SolverBodies &bodies) {
+    for (int lane = 0; lane < ContactBatch::WIDTH; lane++) {
+        const int a = batch.index_a[lane];
+        const int b = batch.index_b[lane];
+        if (batch.inv_mass_a[lane] != 0.0f) {
+            bodies.vx[a] += impulses[0][lane] * batch.inv_mass_a[lane];
+            bodies.vy[a] += impulses[1][lane] * batch.inv_mass_a[lane];
+            bodies.w[a] += impulses[2][lane] * batch.inv_I_a[lane];
+        }
+        if (batch.inv_mass_b[lane] != 0.0f) {
+            bodies.vx[b] += impulses[3][lane] * batch.inv_mass_b[lane];
+            bodies.vy[b] += impulses[4][lane] * batch.inv_mass_b[lane];
+            bodies.w[b] += impulses[5][lane] * batch.inv_I_b[lane];
+        }
+    }
+}
+
+/**
+ * PenetrationConstraint::solve() lane by lane, with the same Mat code
+ * Reference for the SIMD version, which has to match it bit for bit
+ */
+static void solve_lanes(ContactBatch &batch,
+                        const float v[6][ContactBatch::WIDTH],
+                        float impulses[6][ContactBatch::WIDTH]) {
+    for (int lane = 0; lane < ContactBatch::WIDTH; lane++) {
+        Mat<2, 6> jacobian;
+        Vec<6> velocities;
+        for (int k = 0; k < 6; k++) {
+            jacobian.rows[0][k] = batch.jacobian[0][k][lane];
+            jacobian.rows[1][k] = batch.jacobian[1][k][lane];
+            velocities[k] = v[k][lane];
+        }
+        Mat<2, 2> lhs;
+        for (int r = 0; r < 2; r++) {
+            lhs.rows[r][0] = batch.lhs[r][0][lane];
+            lhs.rows[r][1] = batch.lhs[r][1][lane];
+        }
+
+        Vec<2> rhs = jacobian * velocities * -1.0f;
+        rhs[0] -= batch.bias[lane];
+        Vec<2> lambda = Mat<2, 2>::solve_gauss_seidel(lhs, rhs);
+
+        Vec<2> old_lambda;
+        old_lambda[0] = batch.lambda[0][lane];
+        old_lambda[1] = batch.lambda[1][lane];
+        Vec<2> cached_lambda = old_lambda + lambda;
+        cached_lambda[0] = (cached_lambda[0] < 0.0f) ? 0.0f : cached_lambda[0];
+        const float friction = batch.friction[lane];
+        if (friction > 0.0) {
+            const float max_friction = cached_lambda[0] * friction;
+            cached_lambda[1] =
+                std::clamp(cached_lambda[1], -max_friction, max_friction);
+        }
+        batch.lambda[0][lane] = cached_lambda[0];
+        batch.lambda[1][lane] = cached_lambda[1];
+
+        const Vec<6> lane_impulses =
+            jacobian.transpose_mul(cached_lambda - old_lambda);
+        for (int k = 0; k < 6; k++) {
+            impulses[k][lane] = lane_impulses[k];
+        }
+    }
+}
+
+#if defined(__SSE2__)
+/**
+ * PenetrationConstraint::solve() in every lane, see there for the steps
+ */
+static void solve_lanes_simd(ContactBatch &batch,
+                             const float v[6][ContactBatch::WIDTH],
+                             float impulses[6][ContactBatch::WIDTH]) {
+    const __m128 zero = _mm_setzero_ps();
+
+    // rhs = -(J * v) - [bias, 0]
+    __m128 rhs[2];
+    for (int r = 0; r < 2; r++) {
+        __m128 sum = zero;
+        for (int k = 0; k < 6; k++) {
+            const __m128 jacobian = _mm_load_ps(batch.jacobian[r][k]);
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_load_ps(v[k]), jacobian));
+        }
+        rhs[r] = _mm_mul_ps(sum, _mm_set1_ps(-1.0f));
+    }
+    rhs[0] = _mm_sub_ps(rhs[0], _mm_load_ps(batch.bias));
+
+    // Mat::solve_gauss_seidel
+    __m128 x[2] = {zero, zero};
+    for (int iter = 0; iter < 2; iter++) {
+        for (int n = 0; n < 2; n++) {
+            const __m128 diagonal = _mm_load_ps(batch.lhs[n][n]);
+            const __m128 lhs_0 = _mm_load_ps(batch.lhs[n][0]);
+            const __m128 lhs_1 = _mm_load_ps(batch.lhs[n][1]);
+            const __m128 dot =
+                _mm_add_ps(_mm_add_ps(zero, _mm_mul_ps(lhs_0, x[0])),
+                           _mm_mul_ps(lhs_1, x[1]));
+            const __m128 dx = _mm_sub_ps(_mm_div_ps(rhs[n], diagonal),
+                                         _mm_div_ps(dot, diagonal));
+            // skip lanes where dx is NaN
+            const __m128 valid = _mm_cmpeq_ps(dx, dx);
+            x[n] = _mm_or_ps(_mm_and_ps(valid, _mm_add_ps(x[n], dx)),
+                             _mm_andnot_ps(valid, x[n]));
+        }
+    }
+
+    // accumulate, normal impulse only pushes
+    const __m128 old_normal = _mm_load_ps(batch.lambda[0]);
+    const __m128 old_tangent = _mm_load_ps(batch.lambda[1]);
+    __m128 normal = _mm_add_ps(old_normal, x[0]);
+    __m128 tangent = _mm_add_ps(old_tangent, x[1]);
+    normal = _mm_andnot_ps(_mm_cmplt_ps(normal, zero), normal);
+
+    // keep friction between -(λn*μ) and (λn*μ), where there is friction
+    const __m128 friction = _mm_load_ps(batch.friction);
+    const __m128 max_friction = _mm_mul_ps(normal, friction);
+    const __m128 min_friction = _mm_xor_ps(max_friction, _mm_set1_ps(-0.0f));
+    const __m128 below = _mm_cmplt_ps(tangent, min_friction);
+    const __m128 above = _mm_cmplt_ps(max_friction, tangent);
+    __m128 clamped = _mm_or_ps(_mm_and_ps(above, max_friction),
+                               _mm_andnot_ps(above, tangent));
+    clamped = _mm_or_ps(_mm_and_ps(below, min_friction),
+                        _mm_andnot_ps(below, clamped));
+    const __m128 has_friction = _mm_cmpgt_ps(friction, zero);
+    tangent = _mm_or_ps(_mm_and_ps(has_friction, clamped),
+                        _mm_andnot_ps(has_friction, tangent));
+    _mm_store_ps(batch.lambda[0], normal);
+    _mm_store_ps(batch.lambda[1], tangent);
+
+    // impulses = Jt * (new - old)
+    const __m128 delta_normal = _mm_sub_ps(normal, old_normal);
+    const __m128 delta_tangent = _mm_sub_ps(tangent, old_tangent);
+    for (int k = 0; k < 6; k++) {
+        const __m128 sum = _mm_add_ps(
+            _mm_add_ps(zero, _mm_mul_ps(_mm_load_ps(batch.jacobian[0][k]),
+                                        delta_normal)),
+            _mm_mul_ps(_mm_load_ps(batch.jacobian[1][k]), delta_tangent));
+        _mm_store_ps(impulses[k], sum);
+    }
+}
+#endif
+
+void ContactSolver::solve(ContactBatch &batch, SolverBodies &bodies) {
+    alignas(16) float v[6][ContactBatch::WIDTH];
+    alignas(16) float impulses[6][ContactBatch::WIDTH];
+    load_velocities(batch, bodies, v);
+#if defined(__SSE2__)
+    solve_lanes_simd(batch, v, impulses);
+#else
+    solve_lanes(batch, v, impulses);
+#endif
+    apply_impulses(batch, impulses, bodies);
+}
+
+void ContactSolver::solve_reference(ContactBatch &batch,
+                                    SolverBodies &bodies) {
+    alignas(16) float v[6][ContactBatch::WIDTH];
+    alignas(16) float impulses[6][ContactBatch::WIDTH];
+    load_velocities(batch, bodies, v);
+    solve_lanes(batch, v, impulses);
+    apply_impulses(batch, impulses, bodies);
+}
+
+void ContactSolver::store_impulses() const {
+    for (int c = 0; c < num_colors; c++) {
+        const Color &color = colors[c];
+        for (int i = 0; i < color.num_batches; i++) {
+            const ContactBatch &batch = color.batches[i];
+            for (int lane = 0; lane < ContactBatch::WIDTH; lane++) {
+                Vec<2> lambda;
+                lambda[0] = batch.lambda[0][lane];
+                lambda[1] = batch.lambda[1][lane];
+                batch.constraints[lane]->warm_start_from(lambda);
+            }
+        }
+    }
+}
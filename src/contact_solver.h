@@ -0,0 +1,75 @@
+#ifndef CONTACT_SOLVER_H
+#define CONTACT_SOLVER_H
+
+#include "constraint.h"
+#include "constraint_graph.h"
+#include "frame_arena.h"
+#include "solver_bodies.h"
+#include <vector>
+
+/**
+ * WIDTH penetration constraints of one colour, one per SIMD lane
+ * Lanes of a colour share no dynamic body, so the whole batch reads its
+ * velocities, solves and writes them back without conflicts.
+ */
+struct alignas(16) ContactBatch {
+    static const int WIDTH = 4;
+
+    // [row][column][lane]
+    float jacobian[2][6][WIDTH];
+    // J * M^-1 * Jt, it doesn't change during the iterations
+    float lhs[2][2][WIDTH];
+    float bias[WIDTH];
+    float friction[WIDTH];
+    // accumulated normal and friction impulse
+    float lambda[2][WIDTH];
+    float inv_mass_a[WIDTH];
+    float inv_I_a[WIDTH];
+    float inv_mass_b[WIDTH];
+    float inv_I_b[WIDTH];
+    int index_a[WIDTH];
+    int index_b[WIDTH];
+    PenetrationConstraint *constraints[WIDTH];
+};
+
+/**
+ * Solves the penetration constraints of the Baumgarte solver a batch at a
+ * time, with the same arithmetic as PenetrationConstraint::solve() in
+ * every lane, so the result doesn't change
+ * Built once per step after pre_solve(), the batches live in the step's
+ * arena. Joints, manifolds solved as a block and the contacts left over
+ * when a colour doesn't fill the last batch are still solved one by one.
+ */
+class ContactSolver {
+  public:
+    struct Color {
+        ContactBatch *batches = nullptr;
+        int num_batches = 0;
+        std::vector<Constraint *> rest;
+    };
+
+  private:
+    std::vector<Color> colors;
+    int num_colors = 0;
+    // contacts of the colour being built
+    std::vector<PenetrationConstraint *> contacts;
+
+  public:
+    // false without SSE2, solve() would only go through the lanes one by
+    // one, so the world solves every constraint by itself instead
+    static bool is_available();
+
+    void build(const ConstraintGraph &graph, const SolverBodies &bodies,
+               FrameArena &arena);
+    int get_num_colors() const;
+    const Color &get_color(int color) const;
+
+    static void solve(ContactBatch &batch, SolverBodies &bodies);
+    // solve() lane by lane without SIMD, it has to give the same result
+    static void solve_reference(ContactBatch &batch, SolverBodies &bodies);
+    // hand the accumulated impulses back to the constraints for warm
+    // starting
+    void store_impulses() const;
+};
+
+#endif
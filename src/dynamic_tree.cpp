@@ -0,0 +1,315 @@
+#include "dynamic_tree.h"
+#include "aabb.h"
+#include "body.h"
+#include "vec2.h"
+#include <algorithm>
+#include <vector>
+
+bool TreeNode::is_leaf() const { return child1 == NULL_NODE; }
+
+DynamicTree::DynamicTree(float margin) : margin(margin) {}
+
+int DynamicTree::allocate_node() {
+    if (free_list == NULL_NODE) {
+        nodes.push_back(TreeNode());
+        free_list = nodes.size() - 1;
+    }
+
+    int node_id = free_list;
+    free_list = nodes[node_id].parent;
+    nodes[node_id] = TreeNode();
+    nodes[node_id].height = 0;
+    return node_id;
+}
+
+void DynamicTree::free_node(int node_id) {
+    nodes[node_id].parent = free_list;
+    nodes[node_id].height = -1;
+    nodes[node_id].body = nullptr;
+    free_list = node_id;
+}
+
+int DynamicTree::create_proxy(const AABB &aabb, Body *body) {
+    int proxy_id = allocate_node();
+
+    const Vec2 r(margin, margin);
+    nodes[proxy_id].aabb = AABB(aabb.min - r, aabb.max + r);
+    nodes[proxy_id].body = body;
+
+    insert_leaf(proxy_id);
+    proxy_count++;
+    return proxy_id;
+}
+
+void DynamicTree::destroy_proxy(int proxy_id) {
+    remove_leaf(proxy_id);
+    free_node(proxy_id);
+    proxy_count--;
+}
+
+bool DynamicTree::move_proxy(int proxy_id, const AABB &aabb) {
+    if (nodes[proxy_id].aabb.contains(aabb)) {
+        // still inside the fat AABB, nothing to do
+        return false;
+    }
+
+    remove_leaf(proxy_id);
+
+    const Vec2 r(margin, margin);
+    nodes[proxy_id].aabb = AABB(aabb.min - r, aabb.max + r);
+
+    insert_leaf(proxy_id);
+    return true;
+}
+
+const AABB &DynamicTree::get_fat_aabb(int proxy_id) const {
+    return nodes[proxy_id].aabb;
+}
+
+Body *DynamicTree::get_body(int proxy_id) const {
+    return nodes[proxy_id].body;
+}
+
+int DynamicTree::get_height() const {
+    return root == NULL_NODE ? 0 : nodes[root].height;
+}
+
+int DynamicTree::get_proxy_count() const { return proxy_count; }
+
+/**
+ * Walk down from the root, always picking the child whose AABB grows the
+ * least (surface area heuristic), then pair the leaf with the node found.
+ */
+void DynamicTree::insert_leaf(int leaf) {
+    if (root == NULL_NODE) {
+        root = leaf;
+        nodes[root].parent = NULL_NODE;
+        return;
+    }
+
+    // find the best sibling for this leaf
+    const AABB leaf_aabb = nodes[leaf].aabb;
+    int index = root;
+    while (!nodes[index].is_leaf()) {
+        int child1 = nodes[index].child1;
+        int child2 = nodes[index].child2;
+
+        float area = nodes[index].aabb.perimeter();
+        float combined_area =
+            AABB::combine(nodes[index].aabb, leaf_aabb).perimeter();
+
+        // cost of creating a new parent for this node and the new leaf
+        float cost = 2.0f * combined_area;
+        // minimum cost of pushing the leaf further down the tree
+        float inheritance_cost = 2.0f * (combined_area - area);
+
+        auto descend_cost = [&](int child) {
+            float child_cost =
+                AABB::combine(leaf_aabb, nodes[child].aabb).perimeter();
+            if (!nodes[child].is_leaf()) {
+                child_cost -= nodes[child].aabb.perimeter();
+            }
+            return child_cost + inheritance_cost;
+        };
+        float cost1 = descend_cost(child1);
+        float cost2 = descend_cost(child2);
+
+        if (cost < cost1 && cost < cost2) {
+            break;
+        }
+        index = cost1 < cost2 ? child1 : child2;
+    }
+    int sibling = index;
+
+    // create a new parent
+    int old_parent = nodes[sibling].parent;
+    int new_parent = allocate_node();
+    nodes[new_parent].parent = old_parent;
+    nodes[new_parent].aabb = AABB::combine(leaf_aabb, nodes[sibling].aabb);
+    nodes[new_parent].height = nodes[sibling].height + 1;
+    nodes[new_parent].child1 = sibling;
+    nodes[new_parent].child2 = leaf;
+    nodes[sibling].parent = new_parent;
+    nodes[leaf].parent = new_parent;
+
+    if (old_parent != NULL_NODE) {
+        if (nodes[old_parent].child1 == sibling) {
+            nodes[old_parent].child1 = new_parent;
+        } else {
+            nodes[old_parent].child2 = new_parent;
+        }
+    } else {
+        root = new_parent;
+    }
+
+    // walk back up the tree fixing heights and AABBs
+    index = nodes[leaf].parent;
+    while (index != NULL_NODE) {
+        index = balance(index);
+
+        int child1 = nodes[index].child1;
+        int child2 = nodes[index].child2;
+        nodes[index].height =
+            1 + std::max(nodes[child1].height, nodes[child2].height);
+        nodes[index].aabb =
+            AABB::combine(nodes[child1].aabb, nodes[child2].aabb);
+
+        index = nodes[index].parent;
+    }
+}
+
+void DynamicTree::remove_leaf(int leaf) {
+    if (leaf == root) {
+        root = NULL_NODE;
+        return;
+    }
+
+    int parent = nodes[leaf].parent;
+    int grand_parent = nodes[parent].parent;
+    int sibling = nodes[parent].child1 == leaf ? nodes[parent].child2
+                                                : nodes[parent].child1;
+
+    if (grand_parent == NULL_NODE) {
+        root = sibling;
+        nodes[sibling].parent = NULL_NODE;
+        free_node(parent);
+        return;
+    }
+
+    // destroy the parent and connect the sibling to the grand parent
+    if (nodes[grand_parent].child1 == parent) {
+        nodes[grand_parent].child1 = sibling;
+    } else {
+        nodes[grand_parent].child2 = sibling;
+    }
+    nodes[sibling].parent = grand_parent;
+    free_node(parent);
+
+    // adjust ancestor bounds
+    int index = grand_parent;
+    while (index != NULL_NODE) {
+        index = balance(index);
+
+        int child1 = nodes[index].child1;
+        int child2 = nodes[index].child2;
+        nodes[index].aabb =
+            AABB::combine(nodes[child1].aabb, nodes[child2].aabb);
+        nodes[index].height =
+            1 + std::max(nodes[child1].height, nodes[child2].height);
+
+        index = nodes[index].parent;
+    }
+}
+
+/**
+ * Perform a left or right rotation if node A is imbalanced
+ * Returns the new root index of the subtree.
+ *
+ *         A
+ *       /   \
+ *      B     C
+ *     / \   / \
+ *    D   E F   G
+ */
+int DynamicTree::balance(int a) {
+    if (nodes[a].is_leaf() || nodes[a].height < 2) {
+        return a;
+    }
+
+    int b = nodes[a].child1;
+    int c = nodes[a].child2;
+    int balance = nodes[c].height - nodes[b].height;
+
+    // rotate C up
+    if (balance > 1) {
+        int f = nodes[c].child1;
+        int g = nodes[c].child2;
+
+        // swap A and C
+        nodes[c].child1 = a;
+        nodes[c].parent = nodes[a].parent;
+        nodes[a].parent = c;
+
+        // A's old parent should point to C
+        if (nodes[c].parent != NULL_NODE) {
+            if (nodes[nodes[c].parent].child1 == a) {
+                nodes[nodes[c].parent].child1 = c;
+            } else {
+                nodes[nodes[c].parent].child2 = c;
+            }
+        } else {
+            root = c;
+        }
+
+        // rotate
+        if (nodes[f].height > nodes[g].height) {
+            nodes[c].child2 = f;
+            nodes[a].child2 = g;
+            nodes[g].parent = a;
+            nodes[a].aabb = AABB::combine(nodes[b].aabb, nodes[g].aabb);
+            nodes[c].aabb = AABB::combine(nodes[a].aabb, nodes[f].aabb);
+
+            nodes[a].height = 1 + std::max(nodes[b].height, nodes[g].height);
+            nodes[c].height = 1 + std::max(nodes[a].height, nodes[f].height);
+        } else {
+            nodes[c].child2 = g;
+            nodes[a].child2 = f;
+            nodes[f].parent = a;
+            nodes[a].aabb = AABB::combine(nodes[b].aabb, nodes[f].aabb);
+            nodes[c].aabb = AABB::combine(nodes[a].aabb, nodes[g].aabb);
+
+            nodes[a].height = 1 + std::max(nodes[b].height, nodes[f].height);
+            nodes[c].height = 1 + std::max(nodes[a].height, nodes[g].height);
+        }
+
+        return c;
+    }
+
+    // rotate B up
+    if (balance < -1) {
+        int d = nodes[b].child1;
+        int e = nodes[b].child2;
+
+        // swap A and B
+        nodes[b].child1 = a;
+        nodes[b].parent = nodes[a].parent;
+        nodes[a].parent = b;
+
+        // A's old parent should point to B
+        if (nodes[b].parent != NULL_NODE) {
+            if (nodes[nodes[b].parent].child1 == a) {
+                nodes[nodes[b].parent].child1 = b;
+            } else {
+                nodes[nodes[b].parent].child2 = b;
+            }
+        } else {
+            root = b;
+        }
+
+        // rotate
+        if (nodes[d].height > nodes[e].height) {
+            nodes[b].child2 = d;
+            nodes[a].child1 = e;
+            nodes[e].parent = a;
+            nodes[a].aabb = AABB::combine(nodes[c].aabb, nodes[e].aabb);
+            nodes[b].aabb = AABB::combine(nodes[a].aabb, nodes[d].aabb);
+
+            nodes[a].height = 1 + std::max(nodes[c].height, nodes[e].height);
+            nodes[b].height = 1 + std::max(nodes[a].height, nodes[d].height);
+        } else {
+            nodes[b].child2 = e;
+            nodes[a].child1 = d;
+            nodes[d].parent = a;
+            nodes[a].aabb = AABB::combine(nodes[c].aabb, nodes[d].aabb);
+            nodes[b].aabb = AABB::combine(nodes[a].aabb, nodes[e].aabb);
+
+            nodes[a].height = 1 + std::max(nodes[c].height, nodes[d].height);
+            nodes[b].height = 1 + std::max(nodes[a].height, nodes[e].height);
+        }
+
+        return b;
+    }
+
+    return a;
+}
+
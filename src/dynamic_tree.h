@@ -0,0 +1,107 @@
+#ifndef DYNAMIC_TREE_H
+#define DYNAMIC_TREE_H
+
+#include "aabb.h"
+#include "body.h"
+#include <vector>
+
+const int NULL_NODE = -1;
+
+/**
+ * Node of the dynamic tree
+ * Leaves hold one body each (a "proxy"), internal nodes the union of their
+ * children's AABBs
+ */
+struct TreeNode {
+    AABB aabb;
+    Body *body = nullptr;
+
+    // parent while in the tree, next free node while in the free list
+    int parent = NULL_NODE;
+    int child1 = NULL_NODE;
+    int child2 = NULL_NODE;
+
+    // leaf = 0, free node = -1
+    int height = -1;
+
+    bool is_leaf() const;
+};
+
+/**
+ * Dynamic AABB tree (bounding volume hierarchy)
+ * Leaves store a "fat" AABB, i.e. the body's AABB grown by a margin, so a
+ * body can move a little before its leaf has to be reinserted.
+ * Insert, remove and move are O(log n): the tree is kept balanced with AVL
+ * style rotations.
+ */
+class DynamicTree {
+  private:
+    std::vector<TreeNode> nodes;
+    int root = NULL_NODE;
+    int free_list = NULL_NODE;
+    int proxy_count = 0;
+    float margin;
+
+    int allocate_node();
+    void free_node(int node_id);
+
+    void insert_leaf(int leaf);
+    void remove_leaf(int leaf);
+    int balance(int node_id);
+
+  public:
+    DynamicTree(float margin);
+
+    int create_proxy(const AABB &aabb, Body *body);
+    void destroy_proxy(int proxy_id);
+    /**
+     * Returns true if the proxy left its fat AABB and was reinserted
+     */
+    bool move_proxy(int proxy_id, const AABB &aabb);
+
+    const AABB &get_fat_aabb(int proxy_id) const;
+    Body *get_body(int proxy_id) const;
+    int get_height() const;
+    int get_proxy_count() const;
+
+    /**
+     * Call `callback` with every proxy whose fat AABB overlaps `aabb`
+     * Returning false from the callback stops the query.
+     */
+    template <typename Callback>
+    void query(const AABB &aabb, Callback &&callback) const;
+};
+
+// a template so the callback is inlined instead of wrapped in a
+// std::function, which would allocate for bigger captures
+template <typename Callback>
+void DynamicTree::query(const AABB &aabb, Callback &&callback) const {
+    if (root == NULL_NODE) {
+        return;
+    }
+
+    // explicit stack instead of recursion; the tree is balanced so this
+    // stays small
+    int stack[256];
+    int count = 0;
+    stack[count++] = root;
+
+    while (count > 0) {
+        int node_id = stack[--count];
+        const TreeNode &node = nodes[node_id];
+        if (!node.aabb.overlaps(aabb)) {
+            continue;
+        }
+
+        if (node.is_leaf()) {
+            if (!callback(node_id)) {
+                return;
+            }
+        } else {
+            stack[count++] = node.child1;
+            stack[count++] = node.child2;
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,44 @@
+#include "frame_arena.h"
+#include <cstddef>
+#include <vector>
+
+FrameArena::FrameArena(size_t capacity) : capacity(capacity) {
+    data = new char[capacity];
+}
+
+FrameArena::~FrameArena() {
+    delete[] data;
+    for (auto block : overflow) {
+        delete[] block;
+    }
+}
+
+void *FrameArena::allocate(size_t size, size_t alignment) {
+    used += size + alignment;
+
+    const size_t start = (offset + alignment - 1) & ~(alignment - 1);
+    if (start + size <= capacity) {
+        offset = start + size;
+        return data + start;
+    }
+
+    // new[] is aligned for any type the arena holds
+    char *block = new char[size];
+    overflow.push_back(block);
+    return block;
+}
+
+void FrameArena::reset() {
+    for (auto block : overflow) {
+        delete[] block;
+    }
+    overflow.clear();
+
+    if (used > capacity) {
+        delete[] data;
+        capacity = used + used / 2;
+        data = new char[capacity];
+    }
+    offset = 0;
+    used = 0;
+}
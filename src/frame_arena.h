@@ -0,0 +1,44 @@
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Linear allocator for data that only lives for one world step
+ * Allocating bumps an offset into one block, reset() frees everything at
+ * once. A step that needs more than the block holds gets the rest from the
+ * heap and the next reset() grows the block, so once the block is big
+ * enough stepping never calls the global allocator.
+ * Not thread safe, the world keeps one per worker.
+ */
+class FrameArena {
+  private:
+    char *data = nullptr;
+    size_t capacity = 0;
+    size_t offset = 0;
+    // bytes asked for since the last reset, including the overflow
+    size_t used = 0;
+    std::vector<char *> overflow;
+
+  public:
+    FrameArena(size_t capacity = 16 * 1024);
+    ~FrameArena();
+
+    FrameArena(const FrameArena &) = delete;
+    FrameArena &operator=(const FrameArena &) = delete;
+
+    void *allocate(size_t size, size_t alignment);
+
+    // nothing in the arena is ever destroyed, so only plain data goes in
+    template <typename T> T *allocate(int count) {
+        static_assert(std::is_trivially_destructible_v<T>);
+        return (T *)allocate(sizeof(T) * count, alignof(T));
+    }
+
+    // forget every allocation of the step
+    void reset();
+};
+
+#endif
@@ -2,15 +2,19 @@
 #include "vec2.h"
 #include <SDL2/SDL.h>
 #include <SDL2/SDL2_gfxPrimitives.h>
+#include <SDL2/SDL_image.h>
 #include <SDL2/SDL_rect.h>
 #include <SDL2/SDL_render.h>
 #include <SDL2/SDL_video.h>
 #include <iostream>
 #include <math.h>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 SDL_Window *Graphics::window = NULL;
 SDL_Renderer *Graphics::renderer = NULL;
+std::unordered_map<std::string, SDL_Texture *> Graphics::textures;
 int Graphics::window_width = 0;
 int Graphics::window_height = 0;
 
@@ -121,7 +125,27 @@ void Graphics::draw_texture(int x, int y, int width, int height, float rotation,
                      SDL_FLIP_NONE);
 }
 
+SDL_Texture *Graphics::load_texture(const char *file_name) {
+    auto it = textures.find(file_name);
+    if (it != textures.end()) {
+        return it->second;
+    }
+
+    SDL_Texture *texture = NULL;
+    SDL_Surface *surface = IMG_Load(file_name);
+    if (surface) {
+        texture = SDL_CreateTextureFromSurface(renderer, surface);
+        SDL_FreeSurface(surface);
+    }
+    textures[file_name] = texture;
+    return texture;
+}
+
 void Graphics::close_window(void) {
+    for (auto &entry : textures) {
+        SDL_DestroyTexture(entry.second);
+    }
+    textures.clear();
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
     SDL_Quit();
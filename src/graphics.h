@@ -6,6 +6,8 @@
 // #include <SDL2/SDL2_gfxPrimitives.h>
 #include <SDL2/SDL_render.h>
 #include <SDL2/SDL_stdinc.h>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 struct Graphics {
@@ -13,6 +15,8 @@ struct Graphics {
     static int window_height;
     static SDL_Window *window;
     static SDL_Renderer *renderer;
+    // textures loaded so far by file name, freed by close_window()
+    static std::unordered_map<std::string, SDL_Texture *> textures;
 
     static int width();
     static int height();
@@ -34,6 +38,8 @@ struct Graphics {
                                   Uint32 color);
     static void draw_texture(int x, int y, int width, int height,
                              float rotation, SDL_Texture *texture);
+    // load an image once, later calls with the same file share the texture
+    static SDL_Texture *load_texture(const char *file_name);
 };
 
 #endif
@@ -0,0 +1,92 @@
+#include "island.h"
+#include "body.h"
+#include "constants.h"
+#include "constraint.h"
+#include "manifold.h"
+#include <algorithm>
+#include <vector>
+
+int Islands::find(int index) {
+    while (parent[index] != index) {
+        // path halving
+        parent[index] = parent[parent[index]];
+        index = parent[index];
+    }
+    return index;
+}
+
+void Islands::merge(Body *a, Body *b) {
+    if (a->is_static() || b->is_static()) {
+        return;
+    }
+
+    const int root_a = find(a->island_index);
+    const int root_b = find(b->island_index);
+    if (root_a != root_b) {
+        parent[std::max(root_a, root_b)] = std::min(root_a, root_b);
+    }
+}
+
+void Islands::build(const std::vector<Body *> &dynamic_bodies,
+                    const std::vector<Constraint *> &joints,
+                    const std::vector<Manifold *> &manifolds) {
+    const int count = (int)dynamic_bodies.size();
+    parent.resize(count);
+    for (int i = 0; i < count; i++) {
+        parent[i] = i;
+        dynamic_bodies[i]->island_index = i;
+    }
+
+    for (auto joint : joints) {
+        merge(joint->a, joint->b);
+    }
+    for (auto manifold : manifolds) {
+        merge(manifold->a, manifold->b);
+    }
+
+    awake.assign(count, 0);
+    for (int i = 0; i < count; i++) {
+        if (dynamic_bodies[i]->is_awake) {
+            awake[find(i)] = 1;
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        if (awake[find(i)]) {
+            dynamic_bodies[i]->set_awake(true);
+        }
+    }
+}
+
+void Islands::update_sleep(const std::vector<Body *> &dynamic_bodies,
+                           float dt) {
+    const float linear_tolerance_sq =
+        SLEEP_LINEAR_TOLERANCE * SLEEP_LINEAR_TOLERANCE;
+    const float angular_tolerance_sq =
+        SLEEP_ANGULAR_TOLERANCE * SLEEP_ANGULAR_TOLERANCE;
+
+    const int count = (int)dynamic_bodies.size();
+    min_sleep_time.assign(count, TIME_TO_SLEEP);
+    for (int i = 0; i < count; i++) {
+        Body *body = dynamic_bodies[i];
+        if (!body->is_awake) {
+            continue;
+        }
+
+        if (body->velocity.mag_sqaure() > linear_tolerance_sq ||
+            body->angular_vel * body->angular_vel > angular_tolerance_sq) {
+            body->sleep_time = 0.0f;
+        } else {
+            body->sleep_time += dt;
+        }
+
+        const int root = find(i);
+        min_sleep_time[root] = std::min(min_sleep_time[root], body->sleep_time);
+    }
+
+    for (int i = 0; i < count; i++) {
+        Body *body = dynamic_bodies[i];
+        if (body->is_awake && min_sleep_time[find(i)] >= TIME_TO_SLEEP) {
+            body->set_awake(false);
+        }
+    }
+}
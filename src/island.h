@@ -0,0 +1,43 @@
+#ifndef ISLAND_H
+#define ISLAND_H
+
+#include "body.h"
+#include "constraint.h"
+#include "manifold.h"
+#include <vector>
+
+/**
+ * Groups of dynamic bodies connected by contacts or joints
+ * Static bodies don't connect islands, so two stacks on the same floor are
+ * separate islands. An island sleeps and wakes as a whole: if one of its
+ * bodies is awake they all are, and it only falls asleep once every body in
+ * it has been resting for TIME_TO_SLEEP.
+ */
+class Islands {
+  private:
+    // union-find over Body::island_index
+    std::vector<int> parent;
+    // per island root
+    std::vector<char> awake;
+    std::vector<float> min_sleep_time;
+
+    int find(int index);
+    void merge(Body *a, Body *b);
+
+  public:
+    /**
+     * Build the islands of this step and wake every island that has an
+     * awake body, so bodies touched by awake ones are solved with them.
+     */
+    void build(const std::vector<Body *> &dynamic_bodies,
+               const std::vector<Constraint *> &joints,
+               const std::vector<Manifold *> &manifolds);
+
+    /**
+     * Advance the sleep timers of the awake bodies and put islands that
+     * have been resting long enough to sleep.
+     */
+    void update_sleep(const std::vector<Body *> &dynamic_bodies, float dt);
+};
+
+#endif
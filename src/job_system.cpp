@@ -0,0 +1,120 @@
+#include "job_system.h"
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+JobSystem::JobSystem(int num_threads) : queues(std::max(1, num_threads)) {
+    for (int i = 1; i < (int)queues.size(); i++) {
+        threads.emplace_back(&JobSystem::worker_loop, this, i);
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    work_ready.notify_all();
+    for (auto &thread : threads) {
+        thread.join();
+    }
+}
+
+int JobSystem::get_num_workers() const { return (int)queues.size(); }
+
+bool JobSystem::pop(int worker, Task &task) {
+    WorkerQueue &queue = queues[worker];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.head == queue.tasks.size()) {
+        return false;
+    }
+    task = queue.tasks.back();
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool JobSystem::steal(int worker, Task &task) {
+    const int num_workers = get_num_workers();
+    for (int i = 1; i < num_workers; i++) {
+        WorkerQueue &victim = queues[(worker + i) % num_workers];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.head < victim.tasks.size()) {
+            task = victim.tasks[victim.head++];
+            return true;
+        }
+    }
+    return false;
+}
+
+void JobSystem::run_tasks(int worker) {
+    Task task;
+    while (pop(worker, task) || steal(worker, task)) {
+        (*task.fn)(task.begin, task.end, worker);
+
+        const int done = task.end - task.begin;
+        if (remaining.fetch_sub(done) == done) {
+            std::lock_guard<std::mutex> lock(mutex);
+            work_done.notify_all();
+        }
+    }
+}
+
+void JobSystem::worker_loop(int worker) {
+    int seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            work_ready.wait(lock,
+                            [&]() { return stopping || generation != seen; });
+            if (stopping) {
+                return;
+            }
+            seen = generation;
+        }
+        run_tasks(worker);
+    }
+}
+
+void JobSystem::parallel_for(int count, int grain,
+                             const std::function<void(int, int, int)> &fn) {
+    if (count <= 0) {
+        return;
+    }
+    grain = std::max(1, grain);
+    const int num_workers = get_num_workers();
+    if (num_workers == 1 || count <= grain) {
+        fn(0, count, 0);
+        return;
+    }
+
+    // worker w gets the w-th block of tasks, so without stealing every
+    // worker walks a contiguous part of the range
+    const int num_tasks = (count + grain - 1) / grain;
+    remaining.store(count);
+    for (int w = 0; w < num_workers; w++) {
+        const int first = (int)((long long)num_tasks * w / num_workers);
+        const int last = (int)((long long)num_tasks * (w + 1) / num_workers);
+        WorkerQueue &queue = queues[w];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.clear();
+        queue.head = 0;
+        // pushed in reverse so pop() from the back runs them in order
+        for (int t = last - 1; t >= first; t--) {
+            queue.tasks.push_back(
+                {&fn, t * grain, std::min(count, (t + 1) * grain)});
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        generation++;
+    }
+    work_ready.notify_all();
+
+    run_tasks(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    work_done.wait(lock, [&]() { return remaining.load() == 0; });
+}
@@ -0,0 +1,69 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include "task_scheduler.h"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Work-stealing task scheduler
+ * parallel_for() cuts the range into tasks of `grain` items and deals them
+ * out to the workers' queues in contiguous blocks. Each worker takes tasks
+ * from the back of its own queue and, once that's empty, steals from the
+ * front of the others', so uneven tasks (e.g. pairs that do or don't
+ * collide) still keep every core busy.
+ * The calling thread is worker 0, a JobSystem of one thread runs everything
+ * inline.
+ */
+class JobSystem : public TaskScheduler {
+  private:
+    struct Task {
+        const std::function<void(int, int, int)> *fn;
+        int begin;
+        int end;
+    };
+
+    // tasks[head, end) are left, the owner pops from the end and thieves
+    // take from head; a vector instead of a deque keeps its memory between
+    // calls
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::vector<Task> tasks;
+        size_t head = 0;
+    };
+
+    std::vector<std::thread> threads;
+    std::vector<WorkerQueue> queues;
+
+    std::mutex mutex;
+    std::condition_variable work_ready;
+    std::condition_variable work_done;
+    // bumped for every parallel_for() so sleeping workers know to look
+    int generation = 0;
+    bool stopping = false;
+    // items of the current parallel_for() not done yet
+    std::atomic<int> remaining{0};
+
+    void worker_loop(int worker);
+    // run and steal tasks until every queue is empty
+    void run_tasks(int worker);
+    bool pop(int worker, Task &task);
+    bool steal(int worker, Task &task);
+
+  public:
+    JobSystem(int num_threads);
+    ~JobSystem();
+
+    JobSystem(const JobSystem &) = delete;
+    JobSystem &operator=(const JobSystem &) = delete;
+
+    int get_num_workers() const override;
+    void parallel_for(int count, int grain,
+                      const std::function<void(int, int, int)> &fn) override;
+};
+
+#endif
@@ -0,0 +1,41 @@
+#include "manifold.h"
+#include "constraint.h"
+#include "contact.h"
+#include "frame_arena.h"
+#include "mat.h"
+#include <vector>
+
+struct PreviousImpulse {
+    int contact_id;
+    Vec<2> lambda;
+};
+
+void Manifold::update(const Contact *contacts, int num_contacts,
+                      FrameArena &arena) {
+    // the constraints are rebuilt in place, so only their impulses are kept
+    const int num_previous = (int)constraints.size();
+    PreviousImpulse *previous = arena.allocate<PreviousImpulse>(num_previous);
+    for (int i = 0; i < num_previous; i++) {
+        previous[i] = {constraints[i].contact_id,
+                       constraints[i].get_cached_lambda()};
+    }
+    constraints.clear();
+
+    for (int i = 0; i < num_contacts; i++) {
+        const Contact &contact = contacts[i];
+        PenetrationConstraint penetration(contact.a, contact.b, contact.start,
+                                          contact.end, contact.normal,
+                                          contact.id);
+        for (int k = 0; k < num_previous; k++) {
+            if (previous[k].contact_id == contact.id) {
+                penetration.warm_start_from(previous[k].lambda);
+                break;
+            }
+        }
+        constraints.push_back(penetration);
+    }
+
+    if (num_contacts == 2) {
+        block = ManifoldConstraint(&constraints[0], &constraints[1]);
+    }
+}
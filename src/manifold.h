@@ -0,0 +1,32 @@
+#ifndef MANIFOLD_H
+#define MANIFOLD_H
+
+#include "body.h"
+#include "constraint.h"
+#include "contact.h"
+#include "frame_arena.h"
+#include <vector>
+
+/**
+ * All contacts between a pair of bodies, kept alive while they touch
+ * Contacts found again next frame (same Contact::id) keep the impulses they
+ * accumulated, so warm starting has something to start from.
+ */
+struct Manifold {
+    Body *a = nullptr;
+    Body *b = nullptr;
+
+    std::vector<PenetrationConstraint> constraints;
+    // both constraints as one, when there are two
+    ManifoldConstraint block;
+
+    // last world step in which the bodies were touching
+    int last_step = 0;
+
+    // replace the constraints with the new contacts, carrying over the
+    // impulses of contacts that match by id
+    // the old impulses are kept in `arena` while matching
+    void update(const Contact *contacts, int num_contacts, FrameArena &arena);
+};
+
+#endif
@@ -0,0 +1,166 @@
+#ifndef MAT_H
+#define MAT_H
+
+/**
+ * Fixed size counterparts of VecN and MatrixMN
+ * The size is a template parameter, so the data lives inline (on the stack
+ * for temporaries) and solving a constraint never touches the heap.
+ */
+template <int N> struct Vec {
+    float data[N];
+
+    constexpr int size() const { return N; }
+
+    void zero() {
+        for (int i = 0; i < N; i++) {
+            data[i] = 0.0f;
+        }
+    }
+
+    float dot(const Vec<N> &v) const {
+        float sum = 0.0f;
+        for (int i = 0; i < N; i++) {
+            sum += data[i] * v.data[i];
+        }
+        return sum;
+    }
+
+    Vec<N> operator+(const Vec<N> &v) const {
+        Vec<N> result = *this;
+        result += v;
+        return result;
+    }
+    Vec<N> operator-(const Vec<N> &v) const {
+        Vec<N> result = *this;
+        result -= v;
+        return result;
+    }
+    Vec<N> operator*(const float num) const {
+        Vec<N> result = *this;
+        result *= num;
+        return result;
+    }
+
+    Vec<N> &operator+=(const Vec<N> &v) {
+        for (int i = 0; i < N; i++) {
+            data[i] += v.data[i];
+        }
+        return *this;
+    }
+    Vec<N> &operator-=(const Vec<N> &v) {
+        for (int i = 0; i < N; i++) {
+            data[i] -= v.data[i];
+        }
+        return *this;
+    }
+    Vec<N> &operator*=(const float num) {
+        for (int i = 0; i < N; i++) {
+            data[i] *= num;
+        }
+        return *this;
+    }
+
+    float operator[](const int index) const { return data[index]; }
+    float &operator[](const int index) { return data[index]; }
+};
+
+template <int M, int N> struct Mat {
+    Vec<N> rows[M];
+
+    constexpr int num_rows() const { return M; }
+    constexpr int num_cols() const { return N; }
+
+    void zero() {
+        for (int i = 0; i < M; i++) {
+            rows[i].zero();
+        }
+    }
+
+    Mat<N, M> transpose() const {
+        Mat<N, M> result;
+        for (int r = 0; r < N; r++) {
+            for (int c = 0; c < M; c++) {
+                result.rows[r][c] = rows[c][r];
+            }
+        }
+        return result;
+    }
+
+    Vec<M> operator*(const Vec<N> &v) const {
+        Vec<M> result;
+        for (int r = 0; r < M; r++) {
+            result[r] = v.dot(rows[r]);
+        }
+        return result;
+    }
+
+    template <int P> Mat<M, P> operator*(const Mat<N, P> &m) const {
+        Mat<P, N> transposed = m.transpose();
+        Mat<M, P> result;
+        for (int r = 0; r < M; r++) {
+            for (int c = 0; c < P; c++) {
+                result.rows[r][c] = rows[r].dot(transposed.rows[c]);
+            }
+        }
+        return result;
+    }
+
+    /**
+     * M * diag(d) * transpose(M) for a diagonal matrix stored as a vector
+     * This is J * M^-1 * Jt with the inverse mass matrix of a constraint,
+     * without building the mostly zero NxN matrix.
+     */
+    Mat<M, M> mul_diagonal_transpose(const Vec<N> &d) const {
+        Mat<M, M> result;
+        for (int r = 0; r < M; r++) {
+            for (int c = 0; c < M; c++) {
+                float sum = 0.0f;
+                for (int k = 0; k < N; k++) {
+                    sum += (rows[r][k] * d[k]) * rows[c][k];
+                }
+                result.rows[r][c] = sum;
+            }
+        }
+        return result;
+    }
+
+    /**
+     * transpose(M) * v, without building the transposed matrix
+     */
+    Vec<N> transpose_mul(const Vec<M> &v) const {
+        Vec<N> result;
+        for (int c = 0; c < N; c++) {
+            float sum = 0.0f;
+            for (int r = 0; r < M; r++) {
+                sum += rows[r][c] * v[r];
+            }
+            result[c] = sum;
+        }
+        return result;
+    }
+
+    /**
+     * Same iteration as MatrixMN::solve_gauss_seidel
+     */
+    static Vec<M> solve_gauss_seidel(const Mat<M, M> &A, const Vec<M> &b) {
+        Vec<M> X;
+        X.zero();
+
+        // iterate M times
+        for (int iter = 0; iter < M; iter++) {
+            for (int n = 0; n < M; n++) {
+                float dx =
+                    (b[n] / A.rows[n][n]) - (A.rows[n].dot(X) / A.rows[n][n]);
+
+                if (dx == dx) {
+                    // ensure it's not NaN
+                    X[n] += dx;
+                }
+            }
+        }
+
+        return X;
+    }
+};
+
+#endif
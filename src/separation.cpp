@@ -0,0 +1,148 @@
+#include "separation.h"
+#include "vec2.h"
+#include <limits>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+static_assert(sizeof(Vec2) == 2 * sizeof(float),
+              "vertices are read as packed x/y pairs");
+
+float min_projection(const Vec2 *vertices, int count, const Vec2 &origin,
+                     const Vec2 &normal, int &index) {
+    float min_proj = std::numeric_limits<float>::max();
+    index = 0;
+    int i = 0;
+
+#if defined(__SSE2__)
+    if (count >= 4) {
+        const __m128 ox = _mm_set1_ps(origin.x);
+        const __m128 oy = _mm_set1_ps(origin.y);
+        const __m128 nx = _mm_set1_ps(normal.x);
+        const __m128 ny = _mm_set1_ps(normal.y);
+        // every lane keeps its own minimum and the first vertex reaching it
+        __m128 lane_min = _mm_set1_ps(std::numeric_limits<float>::max());
+        __m128i lane_index = _mm_setzero_si128();
+        __m128i current = _mm_setr_epi32(0, 1, 2, 3);
+        const __m128i step = _mm_set1_epi32(4);
+
+        for (; i + 4 <= count; i += 4) {
+            const __m128 v01 = _mm_loadu_ps(&vertices[i].x);
+            const __m128 v23 = _mm_loadu_ps(&vertices[i + 2].x);
+            const __m128 vx = _mm_shuffle_ps(v01, v23, _MM_SHUFFLE(2, 0, 2, 0));
+            const __m128 vy = _mm_shuffle_ps(v01, v23, _MM_SHUFFLE(3, 1, 3, 1));
+            const __m128 proj =
+                _mm_add_ps(_mm_mul_ps(_mm_sub_ps(vx, ox), nx),
+                           _mm_mul_ps(_mm_sub_ps(vy, oy), ny));
+
+            const __m128 less = _mm_cmplt_ps(proj, lane_min);
+            const __m128i less_i = _mm_castps_si128(less);
+            lane_min = _mm_or_ps(_mm_and_ps(less, proj),
+                                 _mm_andnot_ps(less, lane_min));
+            lane_index = _mm_or_si128(_mm_and_si128(less_i, current),
+                                      _mm_andnot_si128(less_i, lane_index));
+            current = _mm_add_epi32(current, step);
+        }
+
+        float mins[4];
+        int indices[4];
+        _mm_storeu_ps(mins, lane_min);
+        _mm_storeu_si128((__m128i *)indices, lane_index);
+        for (int lane = 0; lane < 4; lane++) {
+            if (mins[lane] < min_proj ||
+                (mins[lane] == min_proj && indices[lane] < index)) {
+                min_proj = mins[lane];
+                index = indices[lane];
+            }
+        }
+    }
+#endif
+
+    for (; i < count; i++) {
+        float proj = (vertices[i] - origin).dot(normal);
+        if (proj < min_proj) {
+            min_proj = proj;
+            index = i;
+        }
+    }
+
+    return min_proj;
+}
+
+#if defined(__SSE2__)
+// (b - a[edge]).dot(normal[edge]) for the 4 vertices of b
+template <int edge>
+static __m128 project_onto_edge(__m128 bx, __m128 by, __m128 ax, __m128 ay,
+                                __m128 nx, __m128 ny) {
+    constexpr int lane = _MM_SHUFFLE(edge, edge, edge, edge);
+    const __m128 dx = _mm_sub_ps(bx, _mm_shuffle_ps(ax, ax, lane));
+    const __m128 dy = _mm_sub_ps(by, _mm_shuffle_ps(ay, ay, lane));
+    return _mm_add_ps(_mm_mul_ps(dx, _mm_shuffle_ps(nx, nx, lane)),
+                      _mm_mul_ps(dy, _mm_shuffle_ps(ny, ny, lane)));
+}
+#endif
+
+float box_min_separation(const Vec2 *a, const Vec2 *b, int &index_ref_edge) {
+    float separation = std::numeric_limits<float>::lowest();
+    index_ref_edge = 0;
+
+#if defined(__SSE2__)
+    // both boxes as [x0, x1, x2, x3] and [y0, y1, y2, y3]
+    const __m128 a01 = _mm_loadu_ps(&a[0].x);
+    const __m128 a23 = _mm_loadu_ps(&a[2].x);
+    const __m128 ax = _mm_shuffle_ps(a01, a23, _MM_SHUFFLE(2, 0, 2, 0));
+    const __m128 ay = _mm_shuffle_ps(a01, a23, _MM_SHUFFLE(3, 1, 3, 1));
+    const __m128 b01 = _mm_loadu_ps(&b[0].x);
+    const __m128 b23 = _mm_loadu_ps(&b[2].x);
+    const __m128 bx = _mm_shuffle_ps(b01, b23, _MM_SHUFFLE(2, 0, 2, 0));
+    const __m128 by = _mm_shuffle_ps(b01, b23, _MM_SHUFFLE(3, 1, 3, 1));
+
+    // edge i runs from vertex i to vertex i + 1, its normal is
+    // Vec2(edge.y, -edge.x).normalize() like Vec2::normal()
+    const __m128 edge_x =
+        _mm_sub_ps(_mm_shuffle_ps(ax, ax, _MM_SHUFFLE(0, 3, 2, 1)), ax);
+    const __m128 edge_y =
+        _mm_sub_ps(_mm_shuffle_ps(ay, ay, _MM_SHUFFLE(0, 3, 2, 1)), ay);
+    const __m128 raw_nx = edge_y;
+    const __m128 raw_ny = _mm_sub_ps(_mm_setzero_ps(), edge_x);
+    const __m128 len = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(raw_nx, raw_nx),
+                                              _mm_mul_ps(raw_ny, raw_ny)));
+    // zero length edges keep their zero normal
+    const __m128 non_zero = _mm_cmpneq_ps(len, _mm_setzero_ps());
+    const __m128 nx = _mm_or_ps(_mm_and_ps(non_zero, _mm_div_ps(raw_nx, len)),
+                                _mm_andnot_ps(non_zero, raw_nx));
+    const __m128 ny = _mm_or_ps(_mm_and_ps(non_zero, _mm_div_ps(raw_ny, len)),
+                                _mm_andnot_ps(non_zero, raw_ny));
+
+    // row i: vertices of b projected onto edge i of a
+    __m128 rows[4] = {project_onto_edge<0>(bx, by, ax, ay, nx, ny),
+                      project_onto_edge<1>(bx, by, ax, ay, nx, ny),
+                      project_onto_edge<2>(bx, by, ax, ay, nx, ny),
+                      project_onto_edge<3>(bx, by, ax, ay, nx, ny)};
+
+    // transposed, the lane-wise minimum of the rows is the minimum of each
+    // edge
+    _MM_TRANSPOSE4_PS(rows[0], rows[1], rows[2], rows[3]);
+    const __m128 edge_min = _mm_min_ps(_mm_min_ps(rows[0], rows[1]),
+                                       _mm_min_ps(rows[2], rows[3]));
+    float min_seps[4];
+    _mm_storeu_ps(min_seps, edge_min);
+#else
+    float min_seps[4];
+    for (int i = 0; i < 4; i++) {
+        Vec2 normal = (a[(i + 1) % 4] - a[i]).normal();
+        int support_index;
+        min_seps[i] = min_projection(b, 4, a[i], normal, support_index);
+    }
+#endif
+
+    for (int i = 0; i < 4; i++) {
+        if (separation < min_seps[i]) {
+            separation = min_seps[i];
+            index_ref_edge = i;
+        }
+    }
+
+    return separation;
+}
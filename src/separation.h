@@ -0,0 +1,26 @@
+#ifndef SEPARATION_H
+#define SEPARATION_H
+
+#include "vec2.h"
+
+/**
+ * Kernels of the separating axis test between polygons
+ * With SSE2 they project 4 vertices per instruction, other CPUs run the
+ * same arithmetic one vertex at a time.
+ */
+
+/**
+ * Smallest (vertex - origin).dot(normal) over `count` vertices
+ * `index` gets the first vertex reaching it
+ */
+float min_projection(const Vec2 *vertices, int count, const Vec2 &origin,
+                     const Vec2 &normal, int &index);
+
+/**
+ * PolygonShape::find_min_separation for two boxes, 4 vertices each
+ * All 16 projections run without loops, `index_ref_edge` gets the edge of
+ * `a` with the largest separation
+ */
+float box_min_separation(const Vec2 *a, const Vec2 *b, int &index_ref_edge);
+
+#endif
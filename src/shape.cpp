@@ -1,11 +1,37 @@
 #include "shape.h"
+#include "aabb.h"
+#include "separation.h"
 #include "vec2.h"
+#include "vertex_transform.h"
 #include <algorithm>
 #include <iostream>
 #include <limits>
+#include <new>
 #include <vector>
 
-CircleShape::CircleShape(float radius) : radius(radius) {
+float Shape::get_moment_of_inertia() const {
+    switch (type) {
+    case CIRCLE:
+        return ((const CircleShape *)this)->get_moment_of_inertia();
+    case BOX:
+        return ((const BoxShape *)this)->get_moment_of_inertia();
+    default:
+        return ((const PolygonShape *)this)->get_moment_of_inertia();
+    }
+}
+
+void Shape::update_vertices(float cos_angle, float sin_angle,
+                            const Vec2 &position) {
+    // boxes are polygons here
+    if (type == CIRCLE) {
+        ((CircleShape *)this)->update_vertices(cos_angle, sin_angle, position);
+    } else {
+        ((PolygonShape *)this)->update_vertices(cos_angle, sin_angle,
+                                                position);
+    }
+}
+
+CircleShape::CircleShape(float radius) : Shape(CIRCLE), radius(radius) {
     std::cout << "CircleShape constructor called!" << std::endl;
 }
 
@@ -18,18 +44,22 @@ float CircleShape::get_moment_of_inertia() const {
     return 0.5 * (radius * radius);
 }
 
-void CircleShape::update_vertices([[maybe_unused]] float angle,
-                                  [[maybe_unused]] const Vec2 &position) {
-    // circle have no vertices
-    return;
+void CircleShape::update_vertices([[maybe_unused]] float cos_angle,
+                                  [[maybe_unused]] float sin_angle,
+                                  const Vec2 &position) {
+    // circle have no vertices, only the bounds follow the center
+    Vec2 extent(radius, radius);
+    aabb = AABB(position - extent, position + extent);
 }
 
-ShapeType CircleShape::get_type() const { return CIRCLE; }
-
 Shape *CircleShape::clone() const { return new CircleShape(radius); }
 
+Shape *CircleShape::clone_at(void *memory) const {
+    return new (memory) CircleShape(radius);
+}
+
 PolygonShape::PolygonShape(const std::vector<Vec2> vertices)
-    : local_vertices(vertices), world_vertices(vertices) {
+    : Shape(POLYGON), local_vertices(vertices), world_vertices(vertices) {
 
     float min_x = std::numeric_limits<float>::max();
     float min_y = std::numeric_limits<float>::max();
@@ -58,23 +88,22 @@ PolygonShape::~PolygonShape() {
     std::cout << "PolygonShape destructor called!" << std::endl;
 }
 
-ShapeType PolygonShape::get_type() const { return POLYGON; }
-
 Shape *PolygonShape::clone() const { return new PolygonShape(local_vertices); }
 
+Shape *PolygonShape::clone_at(void *memory) const {
+    return new (memory) PolygonShape(local_vertices);
+}
+
 float PolygonShape::get_moment_of_inertia() const {
     // TODO
     return 5000;
 }
 
-void PolygonShape::update_vertices(float angle, const Vec2 &position) {
-    for (size_t i = 0; i < local_vertices.size(); i++) {
-        // first, rotate
-        world_vertices[i] = local_vertices[i].rotate(angle);
-
-        // then, translate
-        world_vertices[i] += position;
-    }
+void PolygonShape::update_vertices(float cos_angle, float sin_angle,
+                                   const Vec2 &position) {
+    aabb = transform_vertices(local_vertices.data(), world_vertices.data(),
+                              (int)local_vertices.size(), cos_angle,
+                              sin_angle, position);
 }
 
 Vec2 PolygonShape::edge_at(const int index) const {
@@ -99,23 +128,16 @@ float PolygonShape::find_min_separation(const PolygonShape *other,
     for (size_t i = 0; i < this->world_vertices.size(); i++) {
         Vec2 va = this->world_vertices[i];
         Vec2 normal = this->edge_at(i).normal();
-        float min_sep = std::numeric_limits<float>::max();
-        Vec2 min_vertex;
-
-        for (size_t j = 0; j < other->world_vertices.size(); j++) {
-            Vec2 vb = other->world_vertices[j];
-            float proj = (vb - va).dot(normal);
-            if (proj < min_sep) {
-                min_sep = proj;
-                min_vertex = vb;
-            }
-            min_sep = std::min(min_sep, (vb - va).dot(normal));
-        }
+        int min_index;
+        float min_sep =
+            min_projection(other->world_vertices.data(),
+                           (int)other->world_vertices.size(), va, normal,
+                           min_index);
 
         if (separation < min_sep) {
             separation = min_sep;
             index_ref_edge = i;
-            support_point = min_vertex;
+            support_point = other->world_vertices[min_index];
         }
     }
 
@@ -136,16 +158,17 @@ int PolygonShape::find_incident_edge(const Vec2 &normal) const {
     return index_incident_edge;
 }
 
-int PolygonShape::clip_segment_to_line(const std::vector<Vec2> &contacts_in,
-                                       std::vector<Vec2> &contacts_out,
-                                       const Vec2 &c0, const Vec2 &c1) const {
+int PolygonShape::clip_segment_to_line(const ClipVertex *contacts_in,
+                                       ClipVertex *contacts_out,
+                                       const Vec2 &c0, const Vec2 &c1,
+                                       int clip_feature) const {
     // start with no output pionts
     int num_out = 0;
 
     // calculate the distance of end points to the line
     Vec2 normal = (c1 - c0).normalize();
-    float dist0 = (contacts_in[0] - c0).cross(normal);
-    float dist1 = (contacts_in[1] - c0).cross(normal);
+    float dist0 = (contacts_in[0].point - c0).cross(normal);
+    float dist1 = (contacts_in[1].point - c0).cross(normal);
 
     // if the points are behind the plane
     if (dist0 <= 0) {
@@ -162,16 +185,20 @@ int PolygonShape::clip_segment_to_line(const std::vector<Vec2> &contacts_in,
         // find the intersection using linear interpolation
         // lerp(start, end) => start + t * (end - start)
         float t = dist0 / (total_dist);
-        Vec2 contact = contacts_in[0] + (contacts_in[1] - contacts_in[0]) * t;
+        Vec2 contact =
+            contacts_in[0].point +
+            (contacts_in[1].point - contacts_in[0].point) * t;
 
-        contacts_out[num_out] = contact;
+        // the new point belongs to the side plane that cut the edge
+        contacts_out[num_out] = {contact, clip_feature};
         num_out++;
     }
 
     return num_out;
 }
 
-BoxShape::BoxShape(float width, float height) : width(width), height(height) {
+BoxShape::BoxShape(float width, float height)
+    : PolygonShape(BOX), width(width), height(height) {
     // load vertices of the box polygon
     local_vertices.push_back(Vec2(-width / 2.0, -height / 2.0));
     local_vertices.push_back(Vec2(width / 2.0, -height / 2.0));
@@ -189,10 +216,12 @@ BoxShape::~BoxShape() {
     std::cout << "BoxShape destructor called!" << std::endl;
 }
 
-ShapeType BoxShape::get_type() const { return BOX; }
-
 Shape *BoxShape::clone() const { return new BoxShape(width, height); }
 
+Shape *BoxShape::clone_at(void *memory) const {
+    return new (memory) BoxShape(width, height);
+}
+
 float BoxShape::get_moment_of_inertia() const {
     // remember, to be multiplied by `mass`
     return (1.0 / 12.0) * (width * width + height * height);
@@ -1,20 +1,43 @@
 #ifndef SHAPE_H
 #define SHAPE_H
 
+#include "aabb.h"
 #include "vec2.h"
+#include <algorithm>
+#include <cstddef>
 #include <vector>
 
-enum ShapeType { CIRCLE, POLYGON, BOX };
+enum ShapeType { CIRCLE, POLYGON, BOX, NUM_SHAPE_TYPES };
 
+/**
+ * Point of the incident edge while it gets clipped, tagged with the feature
+ * it came from: an incident vertex, or the reference side plane that cut it
+ */
+struct ClipVertex {
+    Vec2 point;
+    int feature;
+};
+
+/**
+ * The shape types are a closed set, so the per step calls switch on the
+ * type tag instead of going through the vtable; only copying and
+ * destroying a shape are virtual.
+ */
 struct Shape {
+    // world space bounds, refreshed by update_vertices
+    AABB aabb;
+    ShapeType type;
+
+    Shape(ShapeType type) : type(type) {}
     virtual ~Shape() = default;
-    virtual ShapeType get_type() const = 0; // pure virtual method
+    ShapeType get_type() const { return type; }
     virtual Shape *clone() const = 0;
-    // virtual float get_moment_of_inertia() const = 0;
+    // copy into `memory`, which must hold MAX_SHAPE_SIZE bytes
+    virtual Shape *clone_at(void *memory) const = 0;
 
-    virtual float get_moment_of_inertia() const = 0;
-
-    virtual void update_vertices(float angle, const Vec2 &position) = 0;
+    float get_moment_of_inertia() const;
+    void update_vertices(float cos_angle, float sin_angle,
+                         const Vec2 &position);
 };
 
 struct CircleShape : public Shape {
@@ -22,12 +45,13 @@ struct CircleShape : public Shape {
 
     CircleShape(const float radius);
     virtual ~CircleShape();
-    ShapeType get_type() const override;
     Shape *clone() const override;
+    Shape *clone_at(void *memory) const override;
 
-    float get_moment_of_inertia() const override;
+    float get_moment_of_inertia() const;
 
-    void update_vertices(float angle, const Vec2 &position) override;
+    void update_vertices(float cos_angle, float sin_angle,
+                         const Vec2 &position);
 };
 
 struct PolygonShape : public Shape {
@@ -37,25 +61,28 @@ struct PolygonShape : public Shape {
     std::vector<Vec2> local_vertices;
     std::vector<Vec2> world_vertices;
 
-    PolygonShape() = default;
+    PolygonShape(ShapeType type = POLYGON) : Shape(type) {}
     PolygonShape(const std::vector<Vec2> vertices);
     virtual ~PolygonShape();
-    ShapeType get_type() const override;
     Shape *clone() const override;
+    Shape *clone_at(void *memory) const override;
 
-    float get_moment_of_inertia() const override;
+    float get_moment_of_inertia() const;
 
     Vec2 edge_at(const int index) const;
     float find_min_separation(const PolygonShape *other, int &index_ref_edge,
                               Vec2 &support_point) const;
     int find_incident_edge(const Vec2 &normal) const;
 
-    int clip_segment_to_line(const std::vector<Vec2> &contacts_in,
-                             std::vector<Vec2> &contacts_out, const Vec2 &c0,
-                             const Vec2 &c1) const;
+    // contacts_in and contacts_out hold two points each
+    int clip_segment_to_line(const ClipVertex *contacts_in,
+                             ClipVertex *contacts_out, const Vec2 &c0,
+                             const Vec2 &c1, int clip_feature) const;
 
     // rotate/translate polygon vertices from local space to world space
-    void update_vertices(float angle, const Vec2 &position) override;
+    // and recompute the AABB from them
+    void update_vertices(float cos_angle, float sin_angle,
+                         const Vec2 &position);
 };
 
 struct BoxShape : public PolygonShape {
@@ -63,10 +90,14 @@ struct BoxShape : public PolygonShape {
     float height;
     BoxShape(float x, float y);
     virtual ~BoxShape();
-    ShapeType get_type() const override;
     Shape *clone() const override;
+    Shape *clone_at(void *memory) const override;
 
-    float get_moment_of_inertia() const override;
+    float get_moment_of_inertia() const;
 };
 
+// room for any of the shapes above, see Shape::clone_at()
+constexpr size_t MAX_SHAPE_SIZE =
+    std::max({sizeof(CircleShape), sizeof(PolygonShape), sizeof(BoxShape)});
+
 #endif
@@ -0,0 +1,93 @@
+#include "shape_batch.h"
+#include "aabb.h"
+#include "body.h"
+#include "shape.h"
+#include "vec2.h"
+#include "vertex_transform.h"
+#include <algorithm>
+
+static int num_vertices(const Body *body) {
+    return (int)((PolygonShape *)body->shape)->local_vertices.size();
+}
+
+void ShapeBatch::build(const std::vector<Body *> &bodies) {
+    blocks.clear();
+    local_x.clear();
+    local_y.clear();
+    circles.clear();
+
+    std::vector<Body *> polygons;
+    for (auto body : bodies) {
+        if (body->shape->type == CIRCLE) {
+            circles.push_back(body);
+        } else {
+            polygons.push_back(body);
+        }
+    }
+    std::stable_sort(polygons.begin(), polygons.end(),
+                     [](const Body *a, const Body *b) {
+                         return num_vertices(a) < num_vertices(b);
+                     });
+
+    for (size_t i = 0; i < polygons.size();) {
+        Block block;
+        block.num_vertices = num_vertices(polygons[i]);
+        block.first = (int)local_x.size();
+        int lanes = 0;
+        while (lanes < 4 && i < polygons.size() &&
+               num_vertices(polygons[i]) == block.num_vertices) {
+            block.bodies[lanes++] = polygons[i++];
+        }
+        for (int l = lanes; l < 4; l++) {
+            block.bodies[l] = block.bodies[lanes - 1];
+        }
+
+        for (int k = 0; k < block.num_vertices; k++) {
+            for (int l = 0; l < 4; l++) {
+                const PolygonShape *polygon =
+                    (PolygonShape *)block.bodies[l]->shape;
+                local_x.push_back(polygon->local_vertices[k].x);
+                local_y.push_back(polygon->local_vertices[k].y);
+            }
+        }
+        blocks.push_back(block);
+    }
+}
+
+int ShapeBatch::get_num_blocks() const { return (int)blocks.size(); }
+
+void ShapeBatch::update_polygons(int begin, int end) {
+    for (int i = begin; i < end; i++) {
+        const Block &block = blocks[i];
+        // the sleeping ones in an awake block get the vertices they have
+        bool awake = false;
+        float cos_angle[4];
+        float sin_angle[4];
+        Vec2 position[4];
+        Vec2 *world[4];
+        AABB *bounds[4];
+        for (int l = 0; l < 4; l++) {
+            Body *body = block.bodies[l];
+            awake = awake || body->is_awake;
+            cos_angle[l] = body->cos_rotation;
+            sin_angle[l] = body->sin_rotation;
+            position[l] = body->position;
+            world[l] = ((PolygonShape *)body->shape)->world_vertices.data();
+            bounds[l] = &body->shape->aabb;
+        }
+        if (awake) {
+            transform_polygons(&local_x[block.first], &local_y[block.first],
+                               block.num_vertices, cos_angle, sin_angle,
+                               position, world, bounds);
+        }
+    }
+}
+
+void ShapeBatch::update_circles() {
+    for (auto body : circles) {
+        if (body->is_awake) {
+            body->shape->update_vertices(body->cos_rotation,
+                                         body->sin_rotation, body->position);
+        }
+    }
+}
@@ -0,0 +1,39 @@
+#ifndef SHAPE_BATCH_H
+#define SHAPE_BATCH_H
+
+#include "body.h"
+#include <vector>
+
+/**
+ * The shapes of the dynamic bodies, set up to be moved many at a time
+ * Polygons are grouped by vertex count and packed in blocks of four, vertex
+ * k of the four next to each other, so transform_polygons() moves a whole
+ * block per call instead of one polygon per transform_vertices() call. A
+ * short last block repeats its last polygon. Circles only need their
+ * bounds moved and are kept apart.
+ */
+class ShapeBatch {
+  public:
+    // pack the shapes of the bodies, again after bodies come or go
+    void build(const std::vector<Body *> &bodies);
+    int get_num_blocks() const;
+    // move the blocks in [begin, end) that have an awake body to their
+    // bodies' poses, cos_rotation and sin_rotation must be up to date
+    void update_polygons(int begin, int end);
+    // the same for the circles of awake bodies
+    void update_circles();
+
+  private:
+    struct Block {
+        Body *bodies[4];
+        int num_vertices;
+        // the local vertices start at local_x/local_y[first]
+        int first;
+    };
+    std::vector<Block> blocks;
+    std::vector<float> local_x;
+    std::vector<float> local_y;
+    std::vector<Body *> circles;
+};
+
+#endif
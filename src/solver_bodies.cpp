@@ -0,0 +1,168 @@
+#include "solver_bodies.h"
+#include "body.h"
+#include "mat.h"
+#include "vec2.h"
+#include <cmath>
+
+void SolverBodies::clear() {
+    vx.clear();
+    vy.clear();
+    w.clear();
+    inv_mass.clear();
+    inv_I.clear();
+    ax.clear();
+    ay.clear();
+    aw.clear();
+    dx.clear();
+    dy.clear();
+    dq.clear();
+    dq_cos.clear();
+    dq_sin.clear();
+}
+
+void SolverBodies::truncate(int count) {
+    vx.resize(count);
+    vy.resize(count);
+    w.resize(count);
+    inv_mass.resize(count);
+    inv_I.resize(count);
+    ax.resize(count);
+    ay.resize(count);
+    aw.resize(count);
+    dx.resize(count);
+    dy.resize(count);
+    dq.resize(count);
+    dq_cos.resize(count);
+    dq_sin.resize(count);
+}
+
+int SolverBodies::add(Body *body) {
+    const int index = (int)vx.size();
+    const bool is_static = body->is_static();
+
+    vx.push_back(body->velocity.x);
+    vy.push_back(body->velocity.y);
+    w.push_back(body->angular_vel);
+    inv_mass.push_back(is_static ? 0.0f : body->inv_mass);
+    inv_I.push_back(is_static ? 0.0f : body->inv_I);
+
+    // forces are still there if they weren't integrated by the body yet
+    ax.push_back(is_static ? 0.0f : body->sum_forces.x * body->inv_mass);
+    ay.push_back(is_static ? 0.0f : body->sum_forces.y * body->inv_mass);
+    aw.push_back(is_static ? 0.0f : body->sum_torque * body->inv_I);
+    dx.push_back(0.0f);
+    dy.push_back(0.0f);
+    dq.push_back(0.0f);
+    dq_cos.push_back(1.0f);
+    dq_sin.push_back(0.0f);
+
+    body->solver_index = index;
+    return index;
+}
+
+void SolverBodies::store(Body *body) const {
+    if (body->is_static()) {
+        return;
+    }
+    const int index = body->solver_index;
+    body->velocity.x = vx[index];
+    body->velocity.y = vy[index];
+    body->angular_vel = w[index];
+}
+
+Vec<6> SolverBodies::get_velocities(int a, int b) const {
+    Vec<6> V;
+    V[0] = vx[a];
+    V[1] = vy[a];
+    V[2] = w[a];
+    V[3] = vx[b];
+    V[4] = vy[b];
+    V[5] = w[b];
+
+    return V;
+}
+
+/**
+ * Mat6x6 with the all inverse mass and inverse I of bodies a and b
+ *  [ 1/ma  0     0     0     0     0     ]
+ *  [ 0     1/ma  0     0     0     0     ]
+ *  [ 0     0     1/Ia  0     0     0     ]
+ *  [ 0     0     0     1/mb  0     0     ]
+ *  [ 0     0     0     0     1/mb  0     ]
+ *  [ 0     0     0     0     0     1/Ib  ]
+ * Only the diagonal is stored
+ */
+Vec<6> SolverBodies::get_inv_matrix(int a, int b) const {
+    Vec<6> inv_m;
+    inv_m[0] = inv_mass[a];
+    inv_m[1] = inv_mass[a];
+    inv_m[2] = inv_I[a];
+    inv_m[3] = inv_mass[b];
+    inv_m[4] = inv_mass[b];
+    inv_m[5] = inv_I[b];
+
+    return inv_m;
+}
+
+void SolverBodies::apply_impulses(int a, int b, const Vec<6> &impulses) {
+    // static bodies are shared by constraints solved on different threads,
+    // so they must not even be written with a zero impulse
+    if (inv_mass[a] != 0.0f) {
+        vx[a] += impulses[0] * inv_mass[a];
+        vy[a] += impulses[1] * inv_mass[a];
+        w[a] += impulses[2] * inv_I[a];
+    }
+    if (inv_mass[b] != 0.0f) {
+        vx[b] += impulses[3] * inv_mass[b];
+        vy[b] += impulses[4] * inv_mass[b];
+        w[b] += impulses[5] * inv_I[b];
+    }
+}
+
+Vec2 SolverBodies::get_velocity(int index) const {
+    return Vec2(vx[index], vy[index]);
+}
+
+float SolverBodies::get_angular_vel(int index) const { return w[index]; }
+
+void SolverBodies::integrate_velocities(float h) {
+    const int count = (int)vx.size();
+    for (int i = 0; i < count; i++) {
+        vx[i] += ax[i] * h;
+        vy[i] += ay[i] * h;
+        w[i] += aw[i] * h;
+    }
+}
+
+void SolverBodies::integrate_positions(float h) {
+    const int count = (int)vx.size();
+    for (int i = 0; i < count; i++) {
+        if (inv_mass[i] == 0.0f) {
+            continue;
+        }
+        dx[i] += vx[i] * h;
+        dy[i] += vy[i] * h;
+        dq[i] += w[i] * h;
+        dq_cos[i] = cos(dq[i]);
+        dq_sin[i] = sin(dq[i]);
+    }
+}
+
+Vec2 SolverBodies::get_delta_position(int index) const {
+    return Vec2(dx[index], dy[index]);
+}
+
+float SolverBodies::get_delta_rotation(int index) const { return dq[index]; }
+
+Vec2 SolverBodies::rotate_by_delta(int index, const Vec2 &r) const {
+    return r.rotate(dq_cos[index], dq_sin[index]);
+}
+
+void SolverBodies::store_pose(Body *body) const {
+    store(body);
+
+    const int index = body->solver_index;
+    body->position += Vec2(dx[index], dy[index]);
+    body->rotation += dq[index];
+    body->update_rotation();
+}
@@ -0,0 +1,70 @@
+#ifndef SOLVER_BODIES_H
+#define SOLVER_BODIES_H
+
+#include "body.h"
+#include "mat.h"
+#include "vec2.h"
+#include <vector>
+
+/**
+ * Velocities and inverse masses of the bodies being solved, as structure of
+ * arrays
+ * The world copies them in before pre_solve and writes the velocities back
+ * after post_solve, so the solver iterations only touch these arrays instead
+ * of the whole Body.
+ * Static bodies get zero inverse mass and inertia, impulses never move them.
+ * Their rows never change, so the world adds them first and keeps them
+ * between steps, see truncate().
+ */
+struct SolverBodies {
+    std::vector<float> vx;
+    std::vector<float> vy;
+    std::vector<float> w;
+    std::vector<float> inv_mass;
+    std::vector<float> inv_I;
+
+    // only used by the soft step solver, see World::SOFT_STEP
+    // acceleration from the forces of this step
+    std::vector<float> ax;
+    std::vector<float> ay;
+    std::vector<float> aw;
+    // how far the body moved and turned so far in this step
+    std::vector<float> dx;
+    std::vector<float> dy;
+    std::vector<float> dq;
+    // cos and sin of dq, refreshed by integrate_positions()
+    std::vector<float> dq_cos;
+    std::vector<float> dq_sin;
+
+    void clear();
+    // drop every body after the first `count`
+    void truncate(int count);
+    // copy the body in and store its index in Body::solver_index
+    int add(Body *body);
+    // copy the solved velocities back to the body, static bodies keep
+    // their own
+    void store(Body *body) const;
+
+    // [vax, vay, wa, vbx, vby, wb]
+    Vec<6> get_velocities(int a, int b) const;
+    // diagonal of the 6x6 inverse mass matrix, the rest of it is zero
+    Vec<6> get_inv_matrix(int a, int b) const;
+    // impulses as produced by Jt * lambda
+    void apply_impulses(int a, int b, const Vec<6> &impulses);
+
+    Vec2 get_velocity(int index) const;
+    float get_angular_vel(int index) const;
+
+    // sub-stepping, static bodies are left alone
+    void integrate_velocities(float h);
+    void integrate_positions(float h);
+    Vec2 get_delta_position(int index) const;
+    float get_delta_rotation(int index) const;
+    // rotate an anchor by how far the body turned so far in this step
+    Vec2 rotate_by_delta(int index, const Vec2 &r) const;
+    // move the body by its deltas and copy the velocities back
+    // the shape is left where it is, see Body::update_rotation()
+    void store_pose(Body *body) const;
+};
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+
+#include <functional>
+
+/**
+ * What the world needs from a thread pool
+ * Implement it to run the world on a pool the application already has,
+ * see World::set_task_scheduler(). JobSystem is the default implementation.
+ */
+class TaskScheduler {
+  public:
+    virtual ~TaskScheduler() = default;
+
+    // threads that may run tasks, including the calling one
+    // worker indices passed to parallel_for() tasks are below this
+    virtual int get_num_workers() const = 0;
+
+    /**
+     * Call fn(begin, end, worker) over ranges covering [0, count) and
+     * return once all of them are done.
+     * Ranges hold about `grain` items. Which worker runs a range is not
+     * fixed, so results must not depend on it.
+     */
+    virtual void
+    parallel_for(int count, int grain,
+                 const std::function<void(int, int, int)> &fn) = 0;
+};
+
+#endif
@@ -0,0 +1,190 @@
+#include "time_of_impact.h"
+#include "body.h"
+#include "constants.h"
+#include "shape.h"
+#include "vec2.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// bullets stop between these depths inside what they hit, within the slop
+// so the contact stops them without pushing back
+const float TOI_TARGET_DEPTH = 0.5f * LINEAR_SLOP;
+const float TOI_TOLERANCE = 0.25f * LINEAR_SLOP;
+const int MAX_TOI_ITERATIONS = 20;
+
+// normal along which a separation was measured, used when the centers
+// or points coincide and there is no direction to take
+static const Vec2 ANY_NORMAL(1.0f, 0.0f);
+
+static float circle_circle_separation(const Body *a, const Body *b,
+                                      Vec2 &normal) {
+    const float ra = ((const CircleShape *)a->shape)->radius;
+    const float rb = ((const CircleShape *)b->shape)->radius;
+    const Vec2 ab = b->position - a->position;
+    const float distance = ab.mag();
+    normal = distance > 0.0f ? ab / distance : ANY_NORMAL;
+    return distance - ra - rb;
+}
+
+static float polygon_circle_separation(const Body *polygon,
+                                       const Body *circle, Vec2 &normal) {
+    const PolygonShape *polygon_shape = (const PolygonShape *)polygon->shape;
+    const float radius = ((const CircleShape *)circle->shape)->radius;
+    const Vec2 &center = circle->position;
+    const std::vector<Vec2> &vertices = polygon_shape->world_vertices;
+
+    // inside the polygon the closest edge is the one it's least behind
+    float face_separation = std::numeric_limits<float>::lowest();
+    for (size_t i = 0; i < vertices.size(); i++) {
+        const Vec2 edge_normal = polygon_shape->edge_at(i).normal();
+        const float separation = (center - vertices[i]).dot(edge_normal);
+        if (separation > face_separation) {
+            face_separation = separation;
+            normal = edge_normal;
+        }
+    }
+    if (face_separation <= 0.0f) {
+        return face_separation - radius;
+    }
+
+    // outside, the closest point can be a vertex, so measure to the edges
+    float distance = std::numeric_limits<float>::max();
+    Vec2 closest = center;
+    for (size_t i = 0; i < vertices.size(); i++) {
+        const Vec2 &v0 = vertices[i];
+        const Vec2 edge = polygon_shape->edge_at(i);
+        const float length_square = edge.mag_sqaure();
+        float t = 0.0f;
+        if (length_square > 0.0f) {
+            t = std::clamp((center - v0).dot(edge) / length_square, 0.0f,
+                           1.0f);
+        }
+        const Vec2 point = v0 + edge * t;
+        const float point_distance = (center - point).mag();
+        if (point_distance < distance) {
+            distance = point_distance;
+            closest = point;
+        }
+    }
+    if (distance > 0.0f) {
+        normal = (center - closest) / distance;
+    }
+    return distance - radius;
+}
+
+static float polygon_polygon_separation(const Body *a, const Body *b,
+                                        Vec2 &normal) {
+    const PolygonShape *a_shape = (const PolygonShape *)a->shape;
+    const PolygonShape *b_shape = (const PolygonShape *)b->shape;
+    int a_edge;
+    int b_edge;
+    Vec2 support_point;
+    const float a_separation =
+        a_shape->find_min_separation(b_shape, a_edge, support_point);
+    const float b_separation =
+        b_shape->find_min_separation(a_shape, b_edge, support_point);
+    // the edge normals point out of their own polygon
+    if (a_separation >= b_separation) {
+        normal = a_shape->edge_at(a_edge).normal();
+        return a_separation;
+    }
+    normal = -b_shape->edge_at(b_edge).normal();
+    return b_separation;
+}
+
+float shape_separation(const Body *a, const Body *b, Vec2 &normal) {
+    normal = ANY_NORMAL;
+    const bool a_circle = a->shape->type == CIRCLE;
+    const bool b_circle = b->shape->type == CIRCLE;
+    if (a_circle && b_circle) {
+        return circle_circle_separation(a, b, normal);
+    }
+    if (a_circle) {
+        const float separation = polygon_circle_separation(b, a, normal);
+        normal = -normal;
+        return separation;
+    }
+    if (b_circle) {
+        return polygon_circle_separation(a, b, normal);
+    }
+    return polygon_polygon_separation(a, b, normal);
+}
+
+// farthest any point of the shape's outline is from the body's center,
+// as far as turning it goes: a turning circle stays where it is
+static float bounding_radius(const Shape *shape) {
+    if (shape->type == CIRCLE) {
+        return 0.0f;
+    }
+    float radius_square = 0.0f;
+    for (const Vec2 &v : ((const PolygonShape *)shape)->local_vertices) {
+        radius_square = std::max(radius_square, v.mag_sqaure());
+    }
+    return sqrtf(radius_square);
+}
+
+float time_of_impact(Body *bullet, const Body *other) {
+    const Vec2 end_position = bullet->position;
+    const float end_rotation = bullet->rotation;
+    const Vec2 delta_position = end_position - bullet->prev_position;
+    const float delta_rotation = end_rotation - bullet->prev_rotation;
+
+    // turning moves no point of the outline faster than this
+    const float max_turn =
+        fabs(delta_rotation) * bounding_radius(bullet->shape);
+    if (delta_position.mag_sqaure() == 0.0f && max_turn == 0.0f) {
+        return 1.0f;
+    }
+
+    float target = -TOI_TARGET_DEPTH;
+    float t = 0.0f;
+    float toi = 1.0f;
+    float first_separation = 0.0f;
+    for (int i = 0; i < MAX_TOI_ITERATIONS; i++) {
+        bullet->position = bullet->prev_position + delta_position * t;
+        bullet->rotation = bullet->prev_rotation + delta_rotation * t;
+        bullet->update_transform();
+
+        Vec2 normal;
+        const float separation = shape_separation(bullet, other, normal);
+        if (i == 0) {
+            first_separation = separation;
+        }
+        if (i == 0 && separation <= target + TOI_TOLERANCE) {
+            // already touching, the contact deals with it unless the bullet
+            // goes on sinking in
+            target = separation - TOI_TARGET_DEPTH;
+        } else if (separation <= target + TOI_TOLERANCE) {
+            toi = t;
+            break;
+        }
+
+        // the separation can't shrink faster than the bullet closes in
+        // along the normal plus its turn, if it doesn't close in at all
+        // (sliding or moving away) it can't reach the target
+        const float closing = delta_position.dot(normal) + max_turn;
+        if (closing <= 0.0f) {
+            break;
+        }
+        if (i == MAX_TOI_ITERATIONS - 1) {
+            // didn't converge: only stop a bullet that has come closer, one
+            // sliding along a surface keeps going
+            if (separation < first_separation - TOI_TOLERANCE) {
+                toi = t;
+            }
+            break;
+        }
+
+        // advance as far as the bullet is guaranteed not to pass the target
+        t += (separation - target) / closing;
+        if (t >= 1.0f) {
+            break;
+        }
+    }
+
+    bullet->position = end_position;
+    bullet->rotation = end_rotation;
+    bullet->update_transform();
+    return toi;
+}
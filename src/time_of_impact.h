@@ -0,0 +1,30 @@
+#ifndef TIME_OF_IMPACT_H
+#define TIME_OF_IMPACT_H
+
+#include "body.h"
+#include "vec2.h"
+
+/**
+ * Distance between the shapes of a and b in their current poses, negative
+ * while they overlap, and the unit normal it is measured along, from a
+ * towards b
+ * Between two polygons this is the largest face separation of the
+ * separating axis test, which is never more than the true distance and
+ * exact once they overlap.
+ */
+float shape_separation(const Body *a, const Body *b, Vec2 &normal);
+
+/**
+ * Conservative advancement of `bullet` from its pose at the start of the
+ * step (prev_position, prev_rotation) to its current pose, against `other`
+ * held at its current pose
+ * Returns the fraction of the motion at which the bullet first sinks a
+ * little into `other`, so the next step finds a contact there, or 1 if it
+ * doesn't hit. Bodies already touching at the start only stop once the
+ * bullet sinks that much deeper than it started, so a bullet sliding or
+ * rolling along a surface isn't held back.
+ * The bullet is back at its current pose afterwards.
+ */
+float time_of_impact(Body *bullet, const Body *other);
+
+#endif
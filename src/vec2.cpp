@@ -21,9 +21,13 @@ void Vec2::scale(const float n) {
 }
 
 Vec2 Vec2::rotate(const float angle) const {
+    return rotate(cos(angle), sin(angle));
+}
+
+Vec2 Vec2::rotate(const float cos_angle, const float sin_angle) const {
     Vec2 result;
-    result.x = x * cos(angle) - y * sin(angle);
-    result.y = x * sin(angle) + y * cos(angle);
+    result.x = x * cos_angle - y * sin_angle;
+    result.y = x * sin_angle + y * cos_angle;
     return result;
 }
 
@@ -18,6 +18,8 @@ struct Vec2 {
     void sub(const Vec2 &v);
     void scale(const float n);
     Vec2 rotate(const float angle) const;
+    // rotate with a precomputed cos and sin of the angle
+    Vec2 rotate(const float cos_angle, const float sin_angle) const;
 
     float mag() const;
     float mag_sqaure() const;
@@ -0,0 +1,184 @@
+#include "vertex_transform.h"
+#include "aabb.h"
+#include "vec2.h"
+#include <algorithm>
+#include <limits>
+
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+static_assert(sizeof(Vec2) == 2 * sizeof(float),
+              "vertices are read as packed x/y pairs");
+static_assert(sizeof(AABB) == 2 * sizeof(Vec2),
+              "bounds are written as min x, min y, max x, max y");
+
+AABB transform_vertices(const Vec2 *local, Vec2 *world, int count,
+                        float cos_angle, float sin_angle,
+                        const Vec2 &position) {
+    Vec2 min(std::numeric_limits<float>::max(),
+             std::numeric_limits<float>::max());
+    Vec2 max(std::numeric_limits<float>::lowest(),
+             std::numeric_limits<float>::lowest());
+    int i = 0;
+
+#if defined(__SSE2__) || defined(__AVX__)
+    // for a pair [x, y]: [x, y] * cos + [y, x] * [-sin, sin] + position
+    __m128 min4 = _mm_set1_ps(std::numeric_limits<float>::max());
+    __m128 max4 = _mm_set1_ps(std::numeric_limits<float>::lowest());
+
+#if defined(__AVX__)
+    const __m256 cos8 = _mm256_set1_ps(cos_angle);
+    const __m256 sin8 = _mm256_setr_ps(-sin_angle, sin_angle, -sin_angle,
+                                       sin_angle, -sin_angle, sin_angle,
+                                       -sin_angle, sin_angle);
+    const __m256 pos8 =
+        _mm256_setr_ps(position.x, position.y, position.x, position.y,
+                       position.x, position.y, position.x, position.y);
+    __m256 min8 = _mm256_set1_ps(std::numeric_limits<float>::max());
+    __m256 max8 = _mm256_set1_ps(std::numeric_limits<float>::lowest());
+    for (; i + 4 <= count; i += 4) {
+        const __m256 v = _mm256_loadu_ps(&local[i].x);
+        // swap x and y in every pair
+        const __m256 swapped = _mm256_permute_ps(v, 0xB1);
+        const __m256 r = _mm256_add_ps(
+            _mm256_add_ps(_mm256_mul_ps(v, cos8), _mm256_mul_ps(swapped, sin8)),
+            pos8);
+        _mm256_storeu_ps(&world[i].x, r);
+        min8 = _mm256_min_ps(min8, r);
+        max8 = _mm256_max_ps(max8, r);
+    }
+    min4 = _mm_min_ps(_mm256_castps256_ps128(min8),
+                      _mm256_extractf128_ps(min8, 1));
+    max4 = _mm_max_ps(_mm256_castps256_ps128(max8),
+                      _mm256_extractf128_ps(max8, 1));
+#endif
+
+    const __m128 cos4 = _mm_set1_ps(cos_angle);
+    const __m128 sin4 = _mm_setr_ps(-sin_angle, sin_angle, -sin_angle,
+                                    sin_angle);
+    const __m128 pos4 =
+        _mm_setr_ps(position.x, position.y, position.x, position.y);
+    for (; i + 2 <= count; i += 2) {
+        const __m128 v = _mm_loadu_ps(&local[i].x);
+        const __m128 swapped = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+        const __m128 r = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(v, cos4), _mm_mul_ps(swapped, sin4)), pos4);
+        _mm_storeu_ps(&world[i].x, r);
+        min4 = _mm_min_ps(min4, r);
+        max4 = _mm_max_ps(max4, r);
+    }
+
+    // fold [x, y, x, y] down to one pair
+    min4 = _mm_min_ps(min4, _mm_movehl_ps(min4, min4));
+    max4 = _mm_max_ps(max4, _mm_movehl_ps(max4, max4));
+    float lanes[4];
+    _mm_storeu_ps(lanes, min4);
+    min = Vec2(lanes[0], lanes[1]);
+    _mm_storeu_ps(lanes, max4);
+    max = Vec2(lanes[0], lanes[1]);
+#endif
+
+    for (; i < count; i++) {
+        // first, rotate, then translate
+        world[i] = local[i].rotate(cos_angle, sin_angle);
+        world[i] += position;
+
+        min.x = std::min(min.x, world[i].x);
+        min.y = std::min(min.y, world[i].y);
+        max.x = std::max(max.x, world[i].x);
+        max.y = std::max(max.y, world[i].y);
+    }
+
+    return AABB(min, max);
+}
+
+void transform_polygons(const float *local_x, const float *local_y,
+                        int count, const float *cos_angle,
+                        const float *sin_angle, const Vec2 *position,
+                        Vec2 *const *world, AABB *const *bounds) {
+#if defined(__SSE2__) || defined(__AVX__)
+    // the same products and sums as transform_vertices(), in lanes:
+    // x * cos + y * -sin + position.x and y * cos + x * sin + position.y
+    const __m128 cos4 = _mm_loadu_ps(cos_angle);
+    const __m128 sin4 = _mm_loadu_ps(sin_angle);
+    const __m128 minus_sin4 = _mm_xor_ps(sin4, _mm_set1_ps(-0.0f));
+    const __m128 x4 = _mm_setr_ps(position[0].x, position[1].x,
+                                  position[2].x, position[3].x);
+    const __m128 y4 = _mm_setr_ps(position[0].y, position[1].y,
+                                  position[2].y, position[3].y);
+    __m128 min_x = _mm_set1_ps(std::numeric_limits<float>::max());
+    __m128 min_y = min_x;
+    __m128 max_x = _mm_set1_ps(std::numeric_limits<float>::lowest());
+    __m128 max_y = max_x;
+
+    auto transform = [&](int k, __m128 &x, __m128 &y) {
+        const __m128 lx = _mm_loadu_ps(local_x + 4 * k);
+        const __m128 ly = _mm_loadu_ps(local_y + 4 * k);
+        x = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(lx, cos4), _mm_mul_ps(ly, minus_sin4)), x4);
+        y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ly, cos4), _mm_mul_ps(lx, sin4)),
+                       y4);
+        min_x = _mm_min_ps(min_x, x);
+        min_y = _mm_min_ps(min_y, y);
+        max_x = _mm_max_ps(max_x, x);
+        max_y = _mm_max_ps(max_y, y);
+    };
+
+    // two vertices per step: transposing [x of 4 lanes] and [y of 4 lanes]
+    // of both gives each polygon its two vertices as one x/y/x/y store
+    int k = 0;
+    for (; k + 2 <= count; k += 2) {
+        __m128 x0, y0, x1, y1;
+        transform(k, x0, y0);
+        transform(k + 1, x1, y1);
+        const __m128 lo0 = _mm_unpacklo_ps(x0, y0);
+        const __m128 hi0 = _mm_unpackhi_ps(x0, y0);
+        const __m128 lo1 = _mm_unpacklo_ps(x1, y1);
+        const __m128 hi1 = _mm_unpackhi_ps(x1, y1);
+        _mm_storeu_ps(&world[0][k].x, _mm_movelh_ps(lo0, lo1));
+        _mm_storeu_ps(&world[1][k].x, _mm_movehl_ps(lo1, lo0));
+        _mm_storeu_ps(&world[2][k].x, _mm_movelh_ps(hi0, hi1));
+        _mm_storeu_ps(&world[3][k].x, _mm_movehl_ps(hi1, hi0));
+    }
+    if (k < count) {
+        __m128 x, y;
+        transform(k, x, y);
+        const __m128 lo = _mm_unpacklo_ps(x, y);
+        const __m128 hi = _mm_unpackhi_ps(x, y);
+        _mm_storel_pi((__m64 *)&world[0][k].x, lo);
+        _mm_storeh_pi((__m64 *)&world[1][k].x, lo);
+        _mm_storel_pi((__m64 *)&world[2][k].x, hi);
+        _mm_storeh_pi((__m64 *)&world[3][k].x, hi);
+    }
+
+    // the bounds transpose the same way, into min x, min y, max x, max y
+    const __m128 min_lo = _mm_unpacklo_ps(min_x, min_y);
+    const __m128 min_hi = _mm_unpackhi_ps(min_x, min_y);
+    const __m128 max_lo = _mm_unpacklo_ps(max_x, max_y);
+    const __m128 max_hi = _mm_unpackhi_ps(max_x, max_y);
+    _mm_storeu_ps(&bounds[0]->min.x, _mm_movelh_ps(min_lo, max_lo));
+    _mm_storeu_ps(&bounds[1]->min.x, _mm_movehl_ps(max_lo, min_lo));
+    _mm_storeu_ps(&bounds[2]->min.x, _mm_movelh_ps(min_hi, max_hi));
+    _mm_storeu_ps(&bounds[3]->min.x, _mm_movehl_ps(max_hi, min_hi));
+#else
+    for (int l = 0; l < 4; l++) {
+        Vec2 min(std::numeric_limits<float>::max(),
+                 std::numeric_limits<float>::max());
+        Vec2 max(std::numeric_limits<float>::lowest(),
+                 std::numeric_limits<float>::lowest());
+        for (int k = 0; k < count; k++) {
+            const Vec2 local(local_x[4 * k + l], local_y[4 * k + l]);
+            Vec2 &vertex = world[l][k];
+            vertex = local.rotate(cos_angle[l], sin_angle[l]);
+            vertex += position[l];
+
+            min.x = std::min(min.x, vertex.x);
+            min.y = std::min(min.y, vertex.y);
+            max.x = std::max(max.x, vertex.x);
+            max.y = std::max(max.y, vertex.y);
+        }
+        *bounds[l] = AABB(min, max);
+    }
+#endif
+}
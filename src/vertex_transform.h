@@ -0,0 +1,31 @@
+#ifndef VERTEX_TRANSFORM_H
+#define VERTEX_TRANSFORM_H
+
+#include "aabb.h"
+#include "vec2.h"
+
+/**
+ * world[i] = local[i] rotated by the angle, plus position, for `count`
+ * vertices; returns their bounds
+ * Vec2 arrays are packed x/y pairs, so vector registers take 4 vertices
+ * with AVX (built with ENABLE_AVX2) or 2 with SSE2, and the rest go through
+ * the scalar loop, which is also the path on other CPUs.
+ */
+AABB transform_vertices(const Vec2 *local, Vec2 *world, int count,
+                        float cos_angle, float sin_angle,
+                        const Vec2 &position);
+
+/**
+ * transform_vertices() for four polygons of `count` vertices at once, one
+ * per SIMD lane
+ * Vertex k of polygon l is local_x/local_y[k * 4 + l] and its pose is
+ * cos_angle/sin_angle/position[l]; world[l] and bounds[l] get what
+ * transform_vertices() gives for it, bit for bit. Without SSE2 the four go
+ * through the scalar loop one after the other.
+ */
+void transform_polygons(const float *local_x, const float *local_y,
+                        int count, const float *cos_angle,
+                        const float *sin_angle, const Vec2 *position,
+                        Vec2 *const *world, AABB *const *bounds);
+
+#endif
@@ -1,33 +1,219 @@
 #include "world.h"
 #include "body.h"
+#include "body_pool.h"
+#include "broad_phase.h"
 #include "collision_detection.h"
 #include "constants.h"
 #include "constraint.h"
+#include "constraint_graph.h"
 #include "contact.h"
-#include "graphics.h"
+#include "frame_arena.h"
+#include "island.h"
+#include "job_system.h"
+#include "manifold.h"
+#include "shape_batch.h"
+#include "solver_bodies.h"
+#include "task_scheduler.h"
+#include "time_of_impact.h"
 #include "vec2.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
 #include <iostream>
 #include <vector>
 
+/**
+ * Drop the speculative contacts from `first` on whose gap the bodies don't
+ * close within dt, judged by the speed of the contact points along the
+ * normal. Bodies moving apart or sliding past each other get no contact, so
+ * they don't end up in the same island either.
+ */
+static void drop_separating_contacts(std::vector<Contact> &contacts,
+                                     size_t first, float dt) {
+    size_t count = first;
+    for (size_t i = first; i < contacts.size(); i++) {
+        const Contact &contact = contacts[i];
+        const float gap = (contact.start - contact.end).dot(contact.normal);
+        if (gap > 0.0f) {
+            const Body *a = contact.a;
+            const Body *b = contact.b;
+            const Vec2 ra = contact.end - a->position;
+            const Vec2 rb = contact.start - b->position;
+            const float wa = a->angular_vel;
+            const float wb = b->angular_vel;
+            const Vec2 va = a->velocity + Vec2(-wa * ra.y, wa * ra.x);
+            const Vec2 vb = b->velocity + Vec2(-wb * rb.y, wb * rb.x);
+            if ((va - vb).dot(contact.normal) * dt < gap) {
+                continue;
+            }
+        }
+        contacts[count++] = contact;
+    }
+    contacts.resize(count);
+}
+
 World::World(float gravity) {
     G = -gravity;
+    set_broad_phase(DYNAMIC_TREE);
+    set_num_threads(1);
     std::cout << "World constructor called!" << std::endl;
 }
 
 World::~World() {
-    for (auto body : bodies) {
-        delete body;
-    }
     for (auto constraint : constraints) {
         delete constraint;
     }
+    delete broad_phase;
+    delete job_system;
+    for (auto arena : arenas) {
+        delete arena;
+    }
     std::cout << "World destructor called!" << std::endl;
 }
 
-void World::add_body(Body *body) { bodies.push_back(body); }
+BodyHandle World::create_body(const Shape &shape, float x, float y,
+                              float mass) {
+    BodyHandle handle = body_pool.create(shape, x, y, mass);
+    Body *body = body_pool.get(handle);
+    body->id = next_body_id++;
+    bodies.push_back(body);
+    if (body->is_static()) {
+        static_bodies.push_back(body);
+        static_geometry.add_body(body);
+        static_rows_dirty = true;
+    } else {
+        dynamic_bodies.push_back(body);
+        broad_phase->add_body(body);
+        shape_batch_dirty = true;
+    }
+    return handle;
+}
+
+void World::destroy_body(BodyHandle handle) {
+    Body *body = body_pool.get(handle);
+    if (!body) {
+        return;
+    }
+
+    // what rested on the body or hung from it has to move once it's gone:
+    // wake those bodies, their islands wake with them in the next step
+    auto wake_other = [&](Body *a, Body *b) {
+        (a == body ? b : a)->set_awake(true);
+    };
+    active_manifolds.erase(
+        std::remove_if(active_manifolds.begin(), active_manifolds.end(),
+                       [&](const Manifold *manifold) {
+                           return manifold->a == body || manifold->b == body;
+                       }),
+        active_manifolds.end());
+    for (auto it = manifolds.begin(); it != manifolds.end();) {
+        if (it->second.a == body || it->second.b == body) {
+            wake_other(it->second.a, it->second.b);
+            it = manifolds.erase(it);
+        } else {
+            it++;
+        }
+    }
+    // the world owns the joints, the ones attached to the body go with it
+    size_t count = 0;
+    for (auto constraint : constraints) {
+        if (constraint->a == body || constraint->b == body) {
+            wake_other(constraint->a, constraint->b);
+            delete constraint;
+        } else {
+            constraints[count++] = constraint;
+        }
+    }
+    constraints.resize(count);
+
+    bodies.erase(std::find(bodies.begin(), bodies.end(), body));
+    if (body->is_static()) {
+        static_bodies.erase(
+            std::find(static_bodies.begin(), static_bodies.end(), body));
+        static_geometry.remove_body(body);
+        static_rows_dirty = true;
+    } else {
+        dynamic_bodies.erase(
+            std::find(dynamic_bodies.begin(), dynamic_bodies.end(), body));
+        broad_phase->remove_body(body);
+        shape_batch_dirty = true;
+    }
+    body_pool.destroy(handle);
+}
+
+Body *World::get_body(BodyHandle handle) const {
+    return body_pool.get(handle);
+}
+
+BodyHandle World::get_handle(const Body *body) const {
+    return body_pool.get_handle(body);
+}
 
 std::vector<Body *> &World::get_bodies() { return bodies; }
 
+void World::set_broad_phase(BroadPhaseType type) {
+    delete broad_phase;
+    switch (type) {
+    case BRUTE_FORCE:
+        broad_phase = new BruteForceBroadPhase();
+        break;
+    case UNIFORM_GRID:
+        // about two 50px boxes per cell
+        broad_phase = new UniformGridBroadPhase(100.0f);
+        break;
+    case DYNAMIC_TREE:
+        // fatten AABBs by 10cm so resting bodies never get reinserted
+        broad_phase = new DynamicTreeBroadPhase(0.1f * PIXELS_PER_METER);
+        break;
+    case SWEEP_AND_PRUNE:
+        broad_phase = new SweepAndPruneBroadPhase();
+        break;
+    }
+    broad_phase->set_scheduler(scheduler);
+
+    for (auto body : dynamic_bodies) {
+        broad_phase->add_body(body);
+    }
+}
+
+void World::set_debug_draw_contact(
+    const std::function<void(const Contact &)> &callback) {
+    debug_draw_contact = callback;
+}
+
+void World::set_iterations(int iterations) {
+    this->iterations = std::max(1, iterations);
+}
+
+void World::set_solver_mode(SolverMode mode) { solver_mode = mode; }
+
+void World::set_wide_solver(bool enabled) { wide_solver = enabled; }
+
+void World::set_block_solver(bool enabled) { block_solver = enabled; }
+
+void World::set_speculative_contacts(bool enabled) {
+    speculative_contacts = enabled;
+}
+
+void World::set_substeps(int substeps) {
+    this->substeps = std::max(1, substeps);
+}
+
+void World::set_num_threads(int num_threads) {
+    const bool own_scheduler = scheduler == job_system;
+    delete job_system;
+    job_system = new JobSystem(std::max(1, num_threads));
+    if (own_scheduler) {
+        set_task_scheduler(nullptr);
+    }
+}
+
+void World::set_task_scheduler(TaskScheduler *scheduler) {
+    this->scheduler = scheduler ? scheduler : job_system;
+    broad_phase->set_scheduler(this->scheduler);
+    static_geometry.set_scheduler(this->scheduler);
+}
+
 void World::apply_force(const Vec2 &force) { forces.push_back(force); }
 void World::apply_torque(float torque) { torques.push_back(torque); }
 
@@ -38,11 +224,21 @@ void World::apply_torque(float torque) { torques.push_back(torque); }
  * 4. integrate velocities to find new positions
  */
 void World::update(float dt) {
-    // create vector of penetration constraints
-    // that will be solved frame per frame
-    std::vector<PenetrationConstraint> pens;
+    step_count++;
+
+    const int num_workers = scheduler->get_num_workers();
+    while ((int)arenas.size() < num_workers + 1) {
+        arenas.push_back(new FrameArena());
+    }
+    for (auto arena : arenas) {
+        arena->reset();
+    }
+
+    // 1. Integrate all forces (a = F/m)
+    // the soft step solver integrates them itself in every substep
+    for_each_awake_body([&](Body *body) {
+        body->save_pose();
 
-    for (auto &body : bodies) {
         Vec2 weight = Vec2(0.0, body->mass * G * PIXELS_PER_METER);
         body->apply_force(weight);
 
@@ -52,65 +248,108 @@ void World::update(float dt) {
         for (auto torque : torques) {
             body->apply_torque(torque);
         }
-    }
 
-    // 1. Integrate all forces (a = F/m)
-    for (auto &body : bodies) {
-        body->integrate_forces(dt);
+        if (solver_mode == BAUMGARTE) {
+            body->integrate_forces(dt);
+        }
+    });
+
+    if (speculative_contacts) {
+        // bounds reach as far as the body moves in this step, so the broad
+        // phase pairs it with what it could hit
+        for (auto body : dynamic_bodies) {
+            if (body->is_awake) {
+                AABB &aabb = body->shape->aabb;
+                const Vec2 motion = body->velocity * dt;
+                aabb = AABB::combine(
+                    aabb, AABB(aabb.min + motion, aabb.max + motion));
+                broad_phase->update_body(body);
+            }
+        }
     }
 
-    for (size_t i = 0; i <= bodies.size() - 1; i++) {
-        for (size_t j = i + 1; j < bodies.size(); j++) {
-            Body *a = bodies[i];
-            Body *b = bodies[j];
-            // a->is_colliding = false;
-            // b->is_colliding = false;
+    // broad phase: only pairs with overlapping AABBs reach the narrow phase
+    // static bodies never pair with each other
+    const std::vector<BodyPair> &dynamic_pairs =
+        broad_phase->find_pairs(dynamic_bodies);
+    static_pairs.clear();
+    static_geometry.find_pairs(dynamic_bodies, static_pairs);
+    pairs.resize(dynamic_pairs.size() + static_pairs.size());
+    std::merge(dynamic_pairs.begin(), dynamic_pairs.end(),
+               static_pairs.begin(), static_pairs.end(), pairs.begin());
 
-            std::vector<Contact> contacts;
-            if (CollisionDetection::is_colliding(a, b, contacts)) {
-                for (auto contact : contacts) {
-                    Graphics::draw_circle(contact.start.x, contact.start.y, 5,
-                                          0.0, 0xFF00FFFF);
-                    Graphics::draw_circle(contact.end.x, contact.end.y, 2, 0.0,
-                                          0xFF00FFFF);
-                    // create a new penetration constraint
-                    // as soon as collision detected
-                    PenetrationConstraint penetration(
-                        contact.a, contact.b, contact.start, contact.end,
-                        contact.normal);
-                    pens.push_back(penetration);
-                    // contact.resolve_collision();
-                }
-            }
+    narrow_phase(dt);
+
+    // forget pairs that stopped touching
+    for (auto it = manifolds.begin(); it != manifolds.end();) {
+        if (it->second.last_step != step_count) {
+            it = manifolds.erase(it);
+        } else {
+            it++;
         }
     }
 
+    // islands wake up as a whole, sleeping ones are left out of the solver
+    islands.build(dynamic_bodies, constraints, active_manifolds);
+
     // 2. solve all constraints
-    for (auto &constraint : constraints) {
-        constraint->pre_solve(dt);
+    // copy the velocities into the solver's arrays first, the iterations
+    // below never touch the bodies themselves
+    // the static rows come first and only change with the static bodies
+    if (static_rows_dirty) {
+        solver_bodies.clear();
+        for (auto body : static_bodies) {
+            solver_bodies.add(body);
+        }
+        static_rows_dirty = false;
+    } else {
+        solver_bodies.truncate((int)static_bodies.size());
     }
-    for (auto &constraint : pens) {
-        constraint.pre_solve(dt);
+    for (auto body : dynamic_bodies) {
+        if (body->is_awake) {
+            solver_bodies.add(body);
+            // the solver took over what's left of the forces
+            body->clear_forces();
+            body->clear_torque();
+        }
+    }
+
+    solver_constraints.clear();
+    for (auto constraint : constraints) {
+        if (constraint->a->is_awake || constraint->b->is_awake) {
+            solver_constraints.push_back(constraint);
+        }
     }
-    for (int i = 0; i < 5; i++) {
-        for (auto &constraint : constraints) {
-            constraint->solve();
+    for (auto manifold : active_manifolds) {
+        if (!manifold->a->is_awake && !manifold->b->is_awake) {
+            continue;
         }
-        for (auto &constraint : pens) {
-            constraint.solve();
+        if (block_solver && solver_mode == BAUMGARTE &&
+            manifold->constraints.size() == 2) {
+            solver_constraints.push_back(&manifold->block);
+            continue;
+        }
+        for (auto &constraint : manifold->constraints) {
+            solver_constraints.push_back(&constraint);
         }
     }
-    for (auto &constraint : constraints) {
-        constraint->post_solve();
+
+    constraint_graph.build(solver_constraints, solver_bodies);
+    if (solver_mode == SOFT_STEP) {
+        solve_soft_step(dt);
+    } else {
+        solve_baumgarte(dt);
     }
-    for (auto &constraint : pens) {
-        constraint.post_solve();
+    // the broad phase follows the bodies before the bullets query it
+    for (auto &body : dynamic_bodies) {
+        if (body->is_awake) {
+            broad_phase->update_body(body);
+        }
     }
+    solve_continuous();
 
-    // 3. integrate velocities (update vertices)
-    for (auto &body : bodies) {
-        body->integrate_velocities(dt);
-    }
+    // 4. put islands that have been resting long enough to sleep
+    islands.update_sleep(dynamic_bodies, dt);
 
     /*
     for (auto body : bodies) {
@@ -121,6 +360,336 @@ void World::update(float dt) {
     // check_collisions();
 }
 
+/**
+ * Workers test batches of pairs and append the contacts to their own
+ * buffer. The buffers are then read back in pair order to wake bodies,
+ * call the debug callback and look up manifolds, so the constraints come
+ * out in the same order as testing the pairs one by one, whichever worker
+ * tested what.
+ */
+void World::narrow_phase(float dt) {
+    const int num_pairs = (int)pairs.size();
+    // contacts with a gap up to the relative speed * dt could close by the
+    // end of the step, the ones that actually close are kept
+    auto collide = [&](Body *a, Body *b, std::vector<Contact> &buffer,
+                       FrameArena &arena) {
+        if (!speculative_contacts) {
+            CollisionDetection::is_colliding(a, b, buffer, arena);
+            return;
+        }
+        const size_t first = buffer.size();
+        CollisionDetection::is_colliding(a, b, buffer, arena,
+                                         (a->velocity - b->velocity).mag() *
+                                             dt);
+        drop_separating_contacts(buffer, first, dt);
+    };
+    const int num_workers = scheduler->get_num_workers();
+    contact_buffers.resize(num_workers + 1);
+    size_t last_contacts = 0;
+    for (auto &buffer : contact_buffers) {
+        last_contacts += buffer.size();
+    }
+    // any worker can be handed most of the pairs, make room in each for all
+    // of last step's contacts so an uneven split doesn't grow a buffer
+    for (auto &buffer : contact_buffers) {
+        buffer.clear();
+        buffer.reserve(last_contacts);
+    }
+    pair_contacts.resize(num_pairs);
+
+    scheduler->parallel_for(
+        num_pairs, 32, [&](int begin, int end, int worker) {
+            std::vector<Contact> &buffer = contact_buffers[worker];
+            for (int i = begin; i < end; i++) {
+                PairContacts &result = pair_contacts[i];
+                // bodies woken by an earlier pair are tested below
+                result.tested = pairs[i].a->is_awake || pairs[i].b->is_awake;
+                result.buffer = worker;
+                result.first = (int)buffer.size();
+                if (result.tested) {
+                    collide(pairs[i].a, pairs[i].b, buffer, *arenas[worker]);
+                }
+                result.count = (int)buffer.size() - result.first;
+            }
+        });
+
+    active_manifolds.clear();
+    updated_manifolds.clear();
+    std::vector<Contact> &late_buffer = contact_buffers[num_workers];
+    for (int i = 0; i < num_pairs; i++) {
+        Body *a = pairs[i].a;
+        Body *b = pairs[i].b;
+        PairContacts &result = pair_contacts[i];
+
+        // nothing moved, keep the manifold of resting bodies as it is
+        if (!a->is_awake && !b->is_awake) {
+            auto it = manifolds.find(pairs[i].key());
+            if (it != manifolds.end()) {
+                it->second.last_step = step_count;
+                active_manifolds.push_back(&it->second);
+            }
+            continue;
+        }
+
+        if (!result.tested) {
+            result.buffer = num_workers;
+            result.first = (int)late_buffer.size();
+            collide(a, b, late_buffer, *arenas[num_workers]);
+            result.count = (int)late_buffer.size() - result.first;
+        }
+        if (result.count == 0) {
+            continue;
+        }
+
+        // touching an awake body wakes a sleeping one up
+        a->set_awake(true);
+        b->set_awake(true);
+
+        if (debug_draw_contact) {
+            const Contact *contacts =
+                &contact_buffers[result.buffer][result.first];
+            for (int k = 0; k < result.count; k++) {
+                debug_draw_contact(contacts[k]);
+            }
+        }
+
+        Manifold &manifold = manifolds[pairs[i].key()];
+        manifold.a = a;
+        manifold.b = b;
+        manifold.last_step = step_count;
+        active_manifolds.push_back(&manifold);
+        updated_manifolds.push_back({&manifold, i});
+    }
+
+    // penetration constraints are rebuilt from the new contacts,
+    // matching contacts keep last step's impulses
+    scheduler->parallel_for(
+        (int)updated_manifolds.size(), 32,
+        [&](int begin, int end, int worker) {
+            for (int k = begin; k < end; k++) {
+                auto [manifold, i] = updated_manifolds[k];
+                const PairContacts &result = pair_contacts[i];
+                manifold->update(&contact_buffers[result.buffer][result.first],
+                                 result.count, *arenas[worker]);
+            }
+        });
+}
+
+void World::for_each_awake_body(const std::function<void(Body *)> &fn) {
+    // walk the pool's slots rather than dynamic_bodies, they're contiguous
+    scheduler->parallel_for(
+        body_pool.get_capacity(), 64, [&](int begin, int end, int) {
+            for (int i = begin; i < end; i++) {
+                Body *body = body_pool.at(i);
+                if (body && body->is_awake) {
+                    fn(body);
+                }
+            }
+        });
+}
+
+void World::for_each_color(const std::function<void(Constraint *)> &fn) {
+    // constraints of one colour touch different dynamic bodies, so each
+    // colour is spread over the threads, one colour after the other
+    const int num_colors = constraint_graph.get_num_colors();
+    for (int c = 0; c < num_colors; c++) {
+        const std::vector<Constraint *> &color = constraint_graph.get_color(c);
+        scheduler->parallel_for(
+            (int)color.size(), 16, [&](int begin, int end, int) {
+                for (int k = begin; k < end; k++) {
+                    fn(color[k]);
+                }
+            });
+    }
+    for (auto constraint : constraint_graph.get_overflow()) {
+        fn(constraint);
+    }
+}
+
+void World::solve_wide() {
+    // a colour's batches and its remaining constraints are independent of
+    // each other, so they share one parallel loop
+    const int num_colors = contact_solver.get_num_colors();
+    for (int c = 0; c < num_colors; c++) {
+        const ContactSolver::Color &color = contact_solver.get_color(c);
+        // the loop body only captures the colour and the world, small
+        // enough for std::function to keep it without allocating
+        scheduler->parallel_for(
+            color.num_batches + (int)color.rest.size(), 8,
+            [&](int begin, int end, int) {
+                const int num_batches = color.num_batches;
+                for (int k = begin; k < end; k++) {
+                    if (k < num_batches) {
+                        ContactSolver::solve(color.batches[k], solver_bodies);
+                    } else {
+                        color.rest[k - num_batches]->solve(solver_bodies);
+                    }
+                }
+            });
+    }
+    for (auto constraint : constraint_graph.get_overflow()) {
+        constraint->solve(solver_bodies);
+    }
+}
+
+void World::solve_baumgarte(float dt) {
+    for_each_color([&](Constraint *constraint) {
+        constraint->pre_solve(solver_bodies, dt);
+    });
+    const bool wide = wide_solver && ContactSolver::is_available();
+    if (wide) {
+        FrameArena &serial_arena = *arenas[scheduler->get_num_workers()];
+        contact_solver.build(constraint_graph, solver_bodies, serial_arena);
+    }
+    for (int i = 0; i < iterations; i++) {
+        if (wide) {
+            solve_wide();
+        } else {
+            for_each_color([&](Constraint *constraint) {
+                constraint->solve(solver_bodies);
+            });
+        }
+    }
+    if (wide) {
+        contact_solver.store_impulses();
+    }
+    for (auto constraint : solver_constraints) {
+        constraint->post_solve(solver_bodies);
+    }
+
+    // 3. integrate velocities (update vertices)
+    for_each_awake_body([&](Body *body) {
+        solver_bodies.store(body);
+        body->integrate_pose(dt);
+    });
+    update_shapes();
+}
+
+/**
+ * Every substep integrates velocities, solves the soft constraints with
+ * their bias, integrates positions and then relaxes: solves again without
+ * bias, so the velocity used to push bodies apart doesn't stay in them.
+ * Restitution is applied once at the end.
+ */
+void World::solve_soft_step(float dt) {
+    const float h = dt / substeps;
+    const float inv_h = 1.0f / h;
+
+    for_each_color(
+        [&](Constraint *constraint) { constraint->prepare(solver_bodies, h); });
+    for (int i = 0; i < substeps; i++) {
+        solver_bodies.integrate_velocities(h);
+        for_each_color([&](Constraint *constraint) {
+            constraint->warm_start(solver_bodies);
+        });
+        for_each_color([&](Constraint *constraint) {
+            constraint->solve_soft(solver_bodies, inv_h, true);
+        });
+        solver_bodies.integrate_positions(h);
+        for_each_color([&](Constraint *constraint) {
+            constraint->solve_soft(solver_bodies, inv_h, false);
+        });
+    }
+    for_each_color([&](Constraint *constraint) {
+        constraint->apply_restitution(solver_bodies);
+    });
+
+    // 3. move the bodies by what they moved in the substeps
+    for_each_awake_body(
+        [&](Body *body) { solver_bodies.store_pose(body); });
+    update_shapes();
+}
+
+void World::update_shapes() {
+    if (shape_batch_dirty) {
+        shape_batch.build(dynamic_bodies);
+        shape_batch_dirty = false;
+    }
+    scheduler->parallel_for(shape_batch.get_num_blocks(), 16,
+                            [&](int begin, int end, int) {
+                                shape_batch.update_polygons(begin, end);
+                            });
+    shape_batch.update_circles();
+}
+
+/**
+ * The contacts only see the poses at the end of each step, so a bullet can
+ * jump over a thin body in one step. Its motion from the start of the step
+ * is swept against everything its swept bounds touch, other bodies held at
+ * their new pose, and it's put back where it first hits. The next step
+ * finds a contact there, so it keeps its velocity until then.
+ * The bodies its swept bounds touch come from the broad phase and the
+ * static tree, not from a loop over every body.
+ */
+void World::solve_continuous() {
+    for (auto body : dynamic_bodies) {
+        if (!body->is_bullet || !body->is_awake) {
+            continue;
+        }
+
+        const Vec2 end_position = body->position;
+        const float end_rotation = body->rotation;
+        const AABB end_aabb = body->shape->aabb;
+        body->position = body->prev_position;
+        body->rotation = body->prev_rotation;
+        body->update_transform();
+        const AABB swept_aabb = AABB::combine(body->shape->aabb, end_aabb);
+        body->position = end_position;
+        body->rotation = end_rotation;
+        body->update_transform();
+
+        ccd_candidates.clear();
+        broad_phase->query(swept_aabb, dynamic_bodies, ccd_candidates);
+        static_geometry.query(swept_aabb, ccd_candidates);
+        float toi = 1.0f;
+        for (auto other : ccd_candidates) {
+            // the broad phase may hand out bodies near the bounds too
+            if (other == body || !swept_aabb.overlaps(other->shape->aabb)) {
+                continue;
+            }
+            toi = std::min(toi, time_of_impact(body, other));
+        }
+        if (toi < 1.0f) {
+            body->position = body->prev_position +
+                             (end_position - body->prev_position) * toi;
+            body->rotation = body->prev_rotation +
+                             (end_rotation - body->prev_rotation) * toi;
+            body->update_transform();
+            broad_phase->update_body(body);
+        }
+    }
+}
+
+int World::step(float elapsed) {
+    // a clock going backwards doesn't take time away
+    accumulator += std::max(0.0f, elapsed);
+
+    int steps = 0;
+    while (accumulator >= fixed_dt && steps < max_steps) {
+        update(fixed_dt);
+        accumulator -= fixed_dt;
+        steps++;
+    }
+    // fell behind, give up on the time we can't catch up on
+    if (accumulator >= fixed_dt) {
+        accumulator = std::fmod(accumulator, fixed_dt);
+    }
+
+    return steps;
+}
+
+void World::set_fixed_timestep(float dt) {
+    // also catches NaN, which compares false against everything
+    fixed_dt = std::max(MIN_TIMESTEP, dt);
+}
+
+void World::set_max_steps(int max_steps) {
+    // with no steps allowed step() would drop all the time it's given
+    this->max_steps = std::max(1, max_steps);
+}
+
+float World::get_alpha() const { return accumulator / fixed_dt; }
+
 void World::check_collisions() {
     /*
     for (size_t i = 0; i <= bodies.size() - 1; i++) {
@@ -2,32 +2,193 @@
 #define WORLD_H
 
 #include "body.h"
+#include "body_pool.h"
+#include "broad_phase.h"
 #include "constraint.h"
+#include "constraint_graph.h"
+#include "contact.h"
+#include "contact_solver.h"
+#include "frame_arena.h"
+#include "island.h"
+#include "job_system.h"
+#include "manifold.h"
+#include "shape_batch.h"
+#include "solver_bodies.h"
+#include "task_scheduler.h"
 #include "vec2.h"
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
 #include <vector>
 
+/**
+ * BAUMGARTE: a few Gauss-Seidel iterations per step, positional errors are
+ * fed back as a velocity bias
+ * SOFT_STEP: the step is split into substeps, each solving soft
+ * (spring-damper) constraints once and then relaxing them without bias
+ */
+enum SolverMode { BAUMGARTE, SOFT_STEP };
+
 class World {
   private:
     float G = 9.8;
+    // owns the bodies and their shapes
+    BodyPool body_pool;
+    // every body in the order it was added, for rendering and lookups
     std::vector<Body *> bodies;
+    // bodies split by whether they have mass when they're added
+    std::vector<Body *> dynamic_bodies;
+    std::vector<Body *> static_bodies;
+    int next_body_id = 0;
     std::vector<Constraint *> constraints;
     std::vector<Vec2> forces;
     std::vector<float> torques;
 
+    // dynamic-dynamic pairs come from the selectable broad phase,
+    // dynamic-static pairs from the static geometry tree
+    BroadPhase *broad_phase = nullptr;
+    StaticGeometry static_geometry;
+    // candidate pairs, reused every frame
+    std::vector<BodyPair> pairs;
+    std::vector<BodyPair> static_pairs;
+    // what a bullet's swept bounds may touch, reused by solve_continuous()
+    std::vector<Body *> ccd_candidates;
+
+    // contact manifolds persist between steps, keyed by BodyPair::key()
+    std::unordered_map<uint64_t, Manifold> manifolds;
+    // manifolds touching this step, in pair order
+    std::vector<Manifold *> active_manifolds;
+    // where the narrow phase put the contacts of a pair
+    struct PairContacts {
+        bool tested;
+        int buffer;
+        int first;
+        int count;
+    };
+    // one contact buffer per worker plus one for pairs tested after the
+    // parallel pass, so workers never push into the same vector
+    std::vector<std::vector<Contact>> contact_buffers;
+    std::vector<PairContacts> pair_contacts;
+    // manifolds to rebuild this step, with their pair index
+    std::vector<std::pair<Manifold *, int>> updated_manifolds;
+    // scratch memory of one step, one arena per worker plus one for the
+    // serial parts, all reset at the start of update()
+    std::vector<FrameArena *> arenas;
+    int step_count = 0;
+
+    // velocities the constraints are solved on, the dynamic bodies are
+    // refilled every step, the static ones when they come or go
+    SolverBodies solver_bodies;
+    bool static_rows_dirty = true;
+    // joints and contacts of this step, in solve order before colouring
+    std::vector<Constraint *> solver_constraints;
+    ConstraintGraph constraint_graph;
+    // contacts of the Baumgarte solver in SIMD batches
+    ContactSolver contact_solver;
+    bool wide_solver = true;
+    bool block_solver = true;
+    Islands islands;
+    // moves the shapes after the solver moved the bodies, rebuilt when
+    // dynamic bodies come or go
+    ShapeBatch shape_batch;
+    bool shape_batch_dirty = true;
+    // every parallel part of update() runs on the scheduler, which is the
+    // world's own job system unless the application passed one in
+    JobSystem *job_system = nullptr;
+    TaskScheduler *scheduler = nullptr;
+
+    // run fn(body) on every awake dynamic body, in pool order
+    void for_each_awake_body(const std::function<void(Body *)> &fn);
+    // run fn on every constraint of the step, colour by colour
+    void for_each_color(const std::function<void(Constraint *)> &fn);
+    // one Baumgarte iteration with the contacts solved in batches
+    void solve_wide();
+    // dt sets how far ahead speculative contacts look
+    void narrow_phase(float dt);
+    void solve_baumgarte(float dt);
+    void solve_soft_step(float dt);
+    // move the shapes of the awake bodies to their new poses
+    void update_shapes();
+    // move bullets back to where their motion of the step first hits
+    void solve_continuous();
+
+    int iterations = 5;
+    bool speculative_contacts = false;
+    SolverMode solver_mode = BAUMGARTE;
+    int substeps = 4;
+
+    // step() advances the world in whole steps of fixed_dt, the time left
+    // over is kept for the next call
+    float fixed_dt = 1.0f / 60.0f;
+    float accumulator = 0.0f;
+    // steps per step() call, time beyond that is dropped so a slow frame
+    // can't make the next one even slower
+    int max_steps = 8;
+
+    // called for every contact found by the narrow phase, if set
+    std::function<void(const Contact &)> debug_draw_contact;
+
   public:
     World(float gravity);
     ~World();
 
-    void add_body(Body *body);
+    // the world owns its bodies, they live in its BodyPool
+    BodyHandle create_body(const Shape &shape, float x, float y, float mass);
+    // does nothing if the body is already gone
+    // joints attached to the body are deleted, bodies touching it or
+    // jointed to it wake up
+    void destroy_body(BodyHandle handle);
+    // nullptr once the body has been destroyed
+    Body *get_body(BodyHandle handle) const;
+    BodyHandle get_handle(const Body *body) const;
     std::vector<Body *> &get_bodies();
 
     void add_constraint(Constraint *constraint);
     std::vector<Constraint *> &get_constraints();
 
+    void set_broad_phase(BroadPhaseType type);
+    // the world doesn't draw anything itself, pass a callback to see contacts
+    void set_debug_draw_contact(
+        const std::function<void(const Contact &)> &callback);
+    // number of solver iterations per step, BAUMGARTE only, at least 1
+    void set_iterations(int iterations);
+    void set_solver_mode(SolverMode mode);
+    // substeps per step, SOFT_STEP only
+    void set_substeps(int substeps);
+    // also make contacts between bodies that could meet within the next
+    // step, at their current velocities, so the solver stops them at the
+    // surface instead of after passing through
+    void set_speculative_contacts(bool enabled);
+    // solve contacts several at a time with SIMD, BAUMGARTE only
+    // on by default where SSE2 is available, the result is the same
+    void set_wide_solver(bool enabled);
+    // solve the two contacts of face to face manifolds together, BAUMGARTE
+    // only, on by default
+    void set_block_solver(bool enabled);
+    // threads the world runs on, including the calling one
+    // the result doesn't depend on it
+    void set_num_threads(int num_threads);
+    // run on the application's own pool instead, the world doesn't own it
+    // nullptr goes back to the world's job system
+    void set_task_scheduler(TaskScheduler *scheduler);
+
     void apply_force(const Vec2 &force);
     void apply_torque(float torque);
 
     void update(float dt);
+
+    /**
+     * Advance by `elapsed` seconds of real time in fixed steps
+     * Returns the number of steps taken. Render the bodies at
+     * Body::get_interpolated_position(get_alpha()) to draw the state
+     * between the last two steps.
+     */
+    int step(float elapsed);
+    void set_fixed_timestep(float dt);
+    // at least 1
+    void set_max_steps(int max_steps);
+    // how far the left over time is into the next step, in [0, 1)
+    float get_alpha() const;
     void check_collisions();
 };
 
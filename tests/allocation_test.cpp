@@ -0,0 +1,128 @@
+#include "src/body.h"
+#include "src/broad_phase.h"
+#include "src/shape.h"
+#include "src/world.h"
+#include <atomic>
+#include <cstdlib>
+#include <gtest/gtest.h>
+#include <memory>
+#include <new>
+#include <tuple>
+
+// every allocation in the process goes through here, so the test can count
+// the ones made while the world steps
+static std::atomic<long> num_allocations{0};
+
+// gcc can't tell these frees pair with the replaced operator new below
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void *operator new(std::size_t size) {
+    num_allocations++;
+    if (void *ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+
+namespace {
+
+/**
+ * Stacks of boxes and a row of balls sliding together along a frictionless
+ * floor, so nothing falls asleep and the same contacts persist every step
+ */
+void build_scene(World &world) {
+    Body *floor =
+        world.get_body(world.create_body(BoxShape(100000, 50), 0, 700, 0.0f));
+    floor->friction = 0.0f;
+    auto add = [&](const Shape &shape, float x, float y) {
+        Body *body = world.get_body(world.create_body(shape, x, y, 1.0f));
+        body->friction = 0.0f;
+        body->restitution = 0.0f;
+        body->velocity = Vec2(200, 0);
+    };
+    for (int stack = 0; stack < 8; stack++) {
+        for (int i = 0; i < 4; i++) {
+            add(BoxShape(40, 40), -2000 + stack * 100, 655 - i * 40);
+        }
+        add(CircleShape(15), -2050 + stack * 100, 660);
+    }
+}
+
+class AllocationTest
+    : public ::testing::TestWithParam<
+          std::tuple<SolverMode, BroadPhaseType, int>> {};
+
+// once the contacts have settled the frame arenas, pools and pair buffers
+// are all warm, and a step shouldn't touch the heap at all
+TEST_P(AllocationTest, SteadyStateStepDoesNotAllocate) {
+    const auto [mode, broad_phase, num_threads] = GetParam();
+    World world(-9.8f);
+    world.set_solver_mode(mode);
+    world.set_broad_phase(broad_phase);
+    world.set_num_threads(num_threads);
+    build_scene(world);
+
+    for (int step = 0; step < 60; step++) {
+        world.update(1.0f / 60.0f);
+    }
+    const long before = num_allocations;
+    for (int step = 0; step < 120; step++) {
+        world.update(1.0f / 60.0f);
+    }
+    EXPECT_EQ(num_allocations - before, 0);
+
+    for (auto body : world.get_bodies()) {
+        EXPECT_TRUE(body->is_static() || body->is_awake);
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Stepping, AllocationTest,
+    ::testing::Combine(::testing::Values(BAUMGARTE, SOFT_STEP),
+                       ::testing::Values(BRUTE_FORCE, UNIFORM_GRID,
+                                         DYNAMIC_TREE, SWEEP_AND_PRUNE),
+                       ::testing::Values(1, 4)));
+
+// rows of boxes drifting past each other, so the tree keeps finding and
+// losing pairs; merging them in reuses the same buffers every frame
+TEST(AllocationTest, TreeFindsNewPairsWithoutAllocating) {
+    std::vector<std::unique_ptr<Body>> owned;
+    std::vector<Body *> bodies;
+    DynamicTreeBroadPhase broad_phase(2.0f);
+    for (int i = 0; i < 200; i++) {
+        owned.emplace_back(
+            new Body(BoxShape(10, 10), i % 20 * 30.0f, i / 20 * 30.0f, 1.0f));
+        owned.back()->id = i;
+        bodies.push_back(owned.back().get());
+        broad_phase.add_body(bodies.back());
+    }
+
+    long allocations = 0;
+    size_t new_pairs = 0;
+    for (int frame = 0; frame < 400; frame++) {
+        // every other box moves the other way, turning round every 50 frames
+        const float speed = frame / 50 % 2 ? -0.7f : 0.7f;
+        for (int i = 0; i < (int)bodies.size(); i++) {
+            bodies[i]->position.x += i % 2 ? speed : -speed;
+            bodies[i]->update_transform();
+            broad_phase.update_body(bodies[i]);
+        }
+        const long before = num_allocations;
+        broad_phase.find_pairs(bodies);
+        // the first round trip sizes the buffers
+        if (frame >= 200) {
+            allocations += num_allocations - before;
+            new_pairs += broad_phase.get_new_pairs().size();
+        }
+    }
+    EXPECT_GT(new_pairs, 0u);
+    EXPECT_EQ(allocations, 0);
+}
+
+} // namespace
@@ -0,0 +1,173 @@
+#include "src/aabb.h"
+#include "src/body.h"
+#include "src/broad_phase.h"
+#include "src/shape.h"
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+
+/**
+ * Boxes and circles of mixed sizes scattered over an area small enough
+ * that many of them overlap, moved around a little every frame
+ */
+class BroadPhaseTest : public ::testing::Test {
+  protected:
+    std::vector<std::unique_ptr<Body>> owned;
+    std::vector<Body *> bodies;
+    std::mt19937 random{42};
+
+    float uniform(float min, float max) {
+        return std::uniform_real_distribution<float>(min, max)(random);
+    }
+
+    void SetUp() override {
+        for (int i = 0; i < 300; i++) {
+            const float x = uniform(0.0f, 1500.0f);
+            const float y = uniform(0.0f, 1000.0f);
+            if (i % 3 == 0) {
+                owned.push_back(std::make_unique<Body>(
+                    CircleShape(uniform(5.0f, 60.0f)), x, y, 1.0f));
+            } else {
+                owned.push_back(std::make_unique<Body>(
+                    BoxShape(uniform(10.0f, 120.0f), uniform(10.0f, 120.0f)),
+                    x, y, 1.0f));
+            }
+            owned.back()->id = i;
+            bodies.push_back(owned.back().get());
+        }
+    }
+
+    void move_bodies(BroadPhase &broad_phase) {
+        for (auto body : bodies) {
+            body->position += Vec2(uniform(-8.0f, 8.0f), uniform(-8.0f, 8.0f));
+            body->rotation += uniform(-0.1f, 0.1f);
+            body->update_transform();
+            broad_phase.update_body(body);
+        }
+    }
+
+    // the i < j loop over every body, keeping the pairs whose AABBs overlap
+    std::vector<std::pair<int, int>> expected_pairs() const {
+        std::vector<std::pair<int, int>> expected;
+        for (size_t i = 0; i < bodies.size(); i++) {
+            for (size_t j = i + 1; j < bodies.size(); j++) {
+                if (bodies[i]->shape->aabb.overlaps(bodies[j]->shape->aabb)) {
+                    expected.push_back({bodies[i]->id, bodies[j]->id});
+                }
+            }
+        }
+        return expected;
+    }
+
+    // drop_separated: broad phases with fat AABBs report more pairs, keep
+    // only those whose actual AABBs overlap
+    static std::vector<std::pair<int, int>>
+    ids_of(const std::vector<BodyPair> &pairs, bool drop_separated) {
+        std::vector<std::pair<int, int>> ids;
+        for (auto &pair : pairs) {
+            if (!drop_separated ||
+                pair.a->shape->aabb.overlaps(pair.b->shape->aabb)) {
+                ids.push_back({pair.a->id, pair.b->id});
+            }
+        }
+        return ids;
+    }
+
+    void expect_brute_force_pairs(BroadPhase &broad_phase,
+                                  bool drop_separated) {
+        for (auto body : bodies) {
+            broad_phase.add_body(body);
+        }
+        for (int frame = 0; frame < 20; frame++) {
+            const std::vector<BodyPair> &pairs =
+                broad_phase.find_pairs(bodies);
+            const auto expected = expected_pairs();
+            ASSERT_FALSE(expected.empty());
+            ASSERT_EQ(ids_of(pairs, drop_separated), expected)
+                << "frame " << frame;
+            move_bodies(broad_phase);
+        }
+    }
+
+    // ids of the bodies among `found` whose AABBs overlap `aabb`, sorted
+    static std::vector<int> ids_touching(const std::vector<Body *> &found,
+                                         const AABB &aabb) {
+        std::vector<int> ids;
+        for (auto body : found) {
+            if (aabb.overlaps(body->shape->aabb)) {
+                ids.push_back(body->id);
+            }
+        }
+        std::sort(ids.begin(), ids.end());
+        return ids;
+    }
+
+    // random boxes, from specks to a third of the area
+    template <typename Query> void expect_queries_find_overlaps(Query query) {
+        for (int i = 0; i < 50; i++) {
+            const Vec2 min(uniform(-100.0f, 1500.0f),
+                           uniform(-100.0f, 1000.0f));
+            const AABB aabb(min, min + Vec2(uniform(1.0f, 500.0f),
+                                            uniform(1.0f, 500.0f)));
+            std::vector<Body *> found;
+            query(aabb, found);
+            EXPECT_EQ(ids_touching(found, aabb), ids_touching(bodies, aabb))
+                << "query " << i;
+        }
+    }
+};
+
+TEST_F(BroadPhaseTest, UniformGridMatchesBruteForce) {
+    UniformGridBroadPhase broad_phase(100.0f);
+    expect_brute_force_pairs(broad_phase, false);
+}
+
+TEST_F(BroadPhaseTest, UniformGridWithSmallCellsMatchesBruteForce) {
+    // bodies span many cells, so pairs are found several times
+    UniformGridBroadPhase broad_phase(15.0f);
+    expect_brute_force_pairs(broad_phase, false);
+}
+
+TEST_F(BroadPhaseTest, SweepAndPruneMatchesBruteForce) {
+    SweepAndPruneBroadPhase broad_phase;
+    expect_brute_force_pairs(broad_phase, false);
+}
+
+TEST_F(BroadPhaseTest, DynamicTreeContainsBruteForce) {
+    DynamicTreeBroadPhase broad_phase(10.0f);
+    expect_brute_force_pairs(broad_phase, true);
+}
+
+TEST_F(BroadPhaseTest, BruteForceFindsOverlappingPairs) {
+    BruteForceBroadPhase broad_phase;
+    expect_brute_force_pairs(broad_phase, false);
+}
+
+TEST_F(BroadPhaseTest, DynamicTreeQueryFindsOverlaps) {
+    DynamicTreeBroadPhase broad_phase(10.0f);
+    for (auto body : bodies) {
+        broad_phase.add_body(body);
+    }
+    for (int frame = 0; frame < 5; frame++) {
+        move_bodies(broad_phase);
+    }
+    expect_queries_find_overlaps([&](const AABB &aabb, auto &found) {
+        broad_phase.query(aabb, bodies, found);
+    });
+}
+
+TEST_F(BroadPhaseTest, StaticGeometryQueryFindsOverlaps) {
+    StaticGeometry static_geometry;
+    for (auto body : bodies) {
+        static_geometry.add_body(body);
+    }
+    expect_queries_find_overlaps([&](const AABB &aabb, auto &found) {
+        static_geometry.query(aabb, found);
+    });
+}
+
+} // namespace
@@ -0,0 +1,169 @@
+#include "src/body.h"
+#include "src/contact_solver.h"
+#include "src/shape.h"
+#include "src/solver_bodies.h"
+#include "src/world.h"
+#include <cstring>
+#include <gtest/gtest.h>
+#include <memory>
+#include <random>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+bool same_bits(float lhs, float rhs) {
+    return std::memcmp(&lhs, &rhs, sizeof(float)) == 0;
+}
+
+/**
+ * Random batches over 8 bodies, a and b of lane i are bodies 2i and 2i + 1
+ * Some lanes have a static body, no friction or a zero diagonal in the
+ * normal mass, which the Gauss-Seidel step has to skip as NaN.
+ */
+class ContactBatchTest : public ::testing::Test {
+  protected:
+    std::mt19937 random{3};
+
+    float uniform(float min, float max) {
+        return std::uniform_real_distribution<float>(min, max)(random);
+    }
+
+    void fill(ContactBatch &batch, SolverBodies &bodies) {
+        bodies.clear();
+        for (int i = 0; i < 2 * ContactBatch::WIDTH; i++) {
+            const bool is_static = uniform(0.0f, 1.0f) < 0.2f;
+            bodies.vx.push_back(uniform(-300.0f, 300.0f));
+            bodies.vy.push_back(uniform(-300.0f, 300.0f));
+            bodies.w.push_back(uniform(-5.0f, 5.0f));
+            bodies.inv_mass.push_back(is_static ? 0.0f : uniform(0.1f, 2.0f));
+            bodies.inv_I.push_back(is_static ? 0.0f : uniform(1e-4f, 1e-2f));
+        }
+
+        for (int lane = 0; lane < ContactBatch::WIDTH; lane++) {
+            const int a = 2 * lane;
+            const int b = 2 * lane + 1;
+            for (int r = 0; r < 2; r++) {
+                for (int k = 0; k < 6; k++) {
+                    batch.jacobian[r][k][lane] = uniform(-30.0f, 30.0f);
+                }
+                batch.lambda[r][lane] = uniform(-50.0f, 200.0f);
+            }
+            const float off_diagonal = uniform(-0.5f, 0.5f);
+            batch.lhs[0][0][lane] = uniform(0.0f, 1.0f) < 0.1f
+                                        ? 0.0f
+                                        : uniform(1.0f, 4.0f);
+            batch.lhs[0][1][lane] = off_diagonal;
+            batch.lhs[1][0][lane] = off_diagonal;
+            batch.lhs[1][1][lane] = uniform(1.0f, 4.0f);
+            batch.bias[lane] = uniform(-100.0f, 100.0f);
+            batch.friction[lane] =
+                uniform(0.0f, 1.0f) < 0.25f ? 0.0f : uniform(0.1f, 1.0f);
+            batch.inv_mass_a[lane] = bodies.inv_mass[a];
+            batch.inv_I_a[lane] = bodies.inv_I[a];
+            batch.inv_mass_b[lane] = bodies.inv_mass[b];
+            batch.inv_I_b[lane] = bodies.inv_I[b];
+            batch.index_a[lane] = a;
+            batch.index_b[lane] = b;
+            batch.constraints[lane] = nullptr;
+        }
+    }
+};
+
+// the SIMD lanes do the same float operations in the same order as the
+// scalar reference, so they must agree to the last bit
+TEST_F(ContactBatchTest, SolveMatchesReference) {
+    for (int round = 0; round < 1000; round++) {
+        ContactBatch batch;
+        SolverBodies bodies;
+        fill(batch, bodies);
+        ContactBatch reference_batch = batch;
+        SolverBodies reference_bodies = bodies;
+
+        // a few iterations, each starting from the last one's impulses
+        for (int iteration = 0; iteration < 4; iteration++) {
+            ContactSolver::solve(batch, bodies);
+            ContactSolver::solve_reference(reference_batch, reference_bodies);
+        }
+
+        for (int lane = 0; lane < ContactBatch::WIDTH; lane++) {
+            for (int r = 0; r < 2; r++) {
+                ASSERT_TRUE(same_bits(batch.lambda[r][lane],
+                                      reference_batch.lambda[r][lane]))
+                    << "round " << round << ", lane " << lane << ", row "
+                    << r;
+            }
+        }
+        for (size_t i = 0; i < bodies.vx.size(); i++) {
+            ASSERT_TRUE(same_bits(bodies.vx[i], reference_bodies.vx[i]));
+            ASSERT_TRUE(same_bits(bodies.vy[i], reference_bodies.vy[i]));
+            ASSERT_TRUE(same_bits(bodies.w[i], reference_bodies.w[i]));
+        }
+    }
+}
+
+/**
+ * Columns of boxes and balls on a floor, with and without friction and
+ * restitution, stepped with and without the wide solver
+ */
+std::unique_ptr<World> make_world(bool wide, bool block, int num_threads) {
+    auto world = std::make_unique<World>(-9.8f);
+    world->set_wide_solver(wide);
+    world->set_block_solver(block);
+    world->set_num_threads(num_threads);
+    world->create_body(BoxShape(1400, 50), 600, 700, 0.0f);
+    for (int column = 0; column < 20; column++) {
+        for (int row = 0; row < 15; row++) {
+            const float x = 30 + column * 60 + row % 2 * 7;
+            const float y = 650 - row * 52;
+            Body *body =
+                row % 3 ? world->get_body(
+                              world->create_body(BoxShape(50, 40), x, y, 1.0f))
+                        : world->get_body(world->create_body(CircleShape(22),
+                                                             x, y, 1.0f));
+            body->friction = column % 3 ? 0.7f : 0.0f;
+            body->restitution = column % 4 == 0 ? 0.5f : 0.0f;
+        }
+    }
+    return world;
+}
+
+class WideSolverTest
+    : public ::testing::TestWithParam<std::tuple<bool, int>> {};
+
+TEST_P(WideSolverTest, SameResultAsScalarSolver) {
+    if (!ContactSolver::is_available()) {
+        GTEST_SKIP() << "no SIMD contact solver on this target";
+    }
+    const auto [block, num_threads] = GetParam();
+    auto scalar = make_world(false, block, 1);
+    auto wide = make_world(true, block, num_threads);
+
+    for (int step = 0; step < 300; step++) {
+        scalar->update(1.0f / 60.0f);
+        wide->update(1.0f / 60.0f);
+
+        const auto &expected = scalar->get_bodies();
+        const auto &bodies = wide->get_bodies();
+        for (size_t i = 0; i < bodies.size(); i++) {
+            ASSERT_TRUE(same_bits(bodies[i]->position.x,
+                                  expected[i]->position.x) &&
+                        same_bits(bodies[i]->position.y,
+                                  expected[i]->position.y) &&
+                        same_bits(bodies[i]->rotation, expected[i]->rotation) &&
+                        same_bits(bodies[i]->velocity.x,
+                                  expected[i]->velocity.x) &&
+                        same_bits(bodies[i]->velocity.y,
+                                  expected[i]->velocity.y) &&
+                        same_bits(bodies[i]->angular_vel,
+                                  expected[i]->angular_vel))
+                << "step " << step << ", body " << i;
+        }
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(Parity, WideSolverTest,
+                         ::testing::Combine(::testing::Bool(),
+                                            ::testing::Values(1, 4)));
+
+} // namespace
@@ -0,0 +1,96 @@
+#include "src/body.h"
+#include "src/shape.h"
+#include "src/world.h"
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <tuple>
+
+namespace {
+
+const float FENCE_LEFT = 475.0f;
+const float FENCE_RIGHT = 525.0f;
+const float FLOOR_TOP = 600.0f;
+
+Body *create_projectile(World &world, bool box, float x, float y) {
+    if (box) {
+        return world.get_body(
+            world.create_body(BoxShape(20, 20), x, y, 1.0f));
+    }
+    return world.get_body(world.create_body(CircleShape(10), x, y, 1.0f));
+}
+
+/**
+ * A circle or a spinning box fired at a 50px fence, fast enough to jump
+ * over it between two steps; returns how far right its center got
+ */
+float fire_at_fence(bool box, bool bullet, bool speculative) {
+    World world(0.0f);
+    world.set_speculative_contacts(speculative);
+    world.create_body(BoxShape(FENCE_RIGHT - FENCE_LEFT, 400),
+                      (FENCE_LEFT + FENCE_RIGHT) / 2, 300, 0.0f);
+    Body *projectile = create_projectile(world, box, 100, 300);
+    projectile->is_bullet = bullet;
+    projectile->velocity = Vec2(3600.0f, 0.0f);
+    projectile->angular_vel = box ? 20.0f : 0.0f;
+
+    float max_x = projectile->position.x;
+    for (int step = 0; step < 60; step++) {
+        world.update(1.0f / 60.0f);
+        max_x = std::max(max_x, projectile->position.x);
+    }
+    return max_x;
+}
+
+/**
+ * Slides a circle or a box along a floor at 3000px/s after it came to
+ * rest there; returns how far it got in a second
+ */
+float slide_on_floor(bool box, bool bullet) {
+    World world(-9.8f);
+    world.create_body(BoxShape(100000, 50), 0, FLOOR_TOP + 25, 0.0f);
+    Body *body = create_projectile(world, box, 0, FLOOR_TOP - 10);
+    for (int step = 0; step < 60; step++) {
+        world.update(1.0f / 60.0f);
+    }
+
+    body->is_bullet = bullet;
+    body->set_awake(true);
+    body->velocity = Vec2(3000.0f, 0.0f);
+    const float start_x = body->position.x;
+    for (int step = 0; step < 60; step++) {
+        world.update(1.0f / 60.0f);
+    }
+    return body->position.x - start_x;
+}
+
+class FenceTest : public ::testing::TestWithParam<std::tuple<bool, bool>> {
+};
+
+// bullets are stopped by the time of impact, other bodies by speculative
+// contacts, either way in front of the fence
+TEST_P(FenceTest, StopsInFrontOfFence) {
+    const auto [box, bullet] = GetParam();
+    EXPECT_LT(fire_at_fence(box, bullet, !bullet), FENCE_LEFT);
+}
+
+INSTANTIATE_TEST_SUITE_P(ContinuousCollision, FenceTest,
+                         ::testing::Combine(::testing::Bool(),
+                                            ::testing::Bool()));
+
+// without either the fence is jumped over, so the test above means something
+TEST(ContinuousCollisionTest, PlainBodiesPassThroughFence) {
+    EXPECT_GT(fire_at_fence(false, false, false), FENCE_RIGHT);
+    EXPECT_GT(fire_at_fence(true, false, false), FENCE_RIGHT);
+}
+
+// a bullet touching the floor isn't held back while it slides along it
+TEST(ContinuousCollisionTest, SlidingBulletMovesLikeOtherBodies) {
+    for (bool box : {false, true}) {
+        const float plain = slide_on_floor(box, false);
+        EXPECT_GT(plain, 1000.0f);
+        EXPECT_NEAR(slide_on_floor(box, true), plain, 1.0f)
+            << (box ? "box" : "circle");
+    }
+}
+
+} // namespace
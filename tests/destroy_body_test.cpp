@@ -0,0 +1,74 @@
+#include "src/body.h"
+#include "src/constraint.h"
+#include "src/shape.h"
+#include "src/world.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace {
+
+const float FLOOR_TOP = 575.0f;
+
+bool any_dynamic_asleep(World &world) {
+    for (auto body : world.get_bodies()) {
+        if (!body->is_static() && !body->is_awake) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// a stack that fell asleep on the floor falls once the floor is gone
+TEST(DestroyBodyTest, RemovingTheFloorWakesTheStack) {
+    World world(-9.8f);
+    const BodyHandle floor =
+        world.create_body(BoxShape(800, 50), 400, FLOOR_TOP + 25, 0.0f);
+    std::vector<Body *> boxes;
+    for (int i = 0; i < 3; i++) {
+        boxes.push_back(world.get_body(
+            world.create_body(BoxShape(50, 50), 400, FLOOR_TOP - 25 - i * 50,
+                              1.0f)));
+    }
+    for (int step = 0; step < 600 && boxes.back()->is_awake; step++) {
+        world.update(1.0f / 60.0f);
+    }
+    ASSERT_FALSE(boxes.front()->is_awake);
+    ASSERT_FALSE(boxes.back()->is_awake);
+    const float resting_y = boxes.back()->position.y;
+
+    world.destroy_body(floor);
+    world.update(1.0f / 60.0f);
+    EXPECT_FALSE(any_dynamic_asleep(world));
+    for (int step = 0; step < 30; step++) {
+        world.update(1.0f / 60.0f);
+    }
+    EXPECT_GT(boxes.back()->position.y, resting_y + 10.0f);
+}
+
+// the joint is deleted with either of its bodies and the other one wakes
+TEST(DestroyBodyTest, JointsGoWithTheirBody) {
+    World world(-9.8f);
+    const BodyHandle a = world.create_body(BoxShape(20, 20), 100, 100, 1.0f);
+    Body *b = world.get_body(world.create_body(BoxShape(20, 20), 130, 100,
+                                               1.0f));
+    Body *c = world.get_body(world.create_body(BoxShape(20, 20), 300, 100,
+                                               1.0f));
+    world.add_constraint(
+        new JointConstraint(world.get_body(a), b, Vec2(115, 100)));
+    world.add_constraint(new JointConstraint(b, c, Vec2(215, 100)));
+    b->set_awake(false);
+
+    world.destroy_body(a);
+    ASSERT_EQ(world.get_constraints().size(), 1u);
+    EXPECT_EQ(world.get_constraints()[0]->a, b);
+    EXPECT_TRUE(b->is_awake);
+    for (int step = 0; step < 10; step++) {
+        world.update(1.0f / 60.0f);
+    }
+
+    world.destroy_body(world.get_handle(c));
+    EXPECT_TRUE(world.get_constraints().empty());
+    world.update(1.0f / 60.0f);
+}
+
+} // namespace
@@ -0,0 +1,100 @@
+#include "src/body.h"
+#include "src/contact.h"
+#include "src/shape.h"
+#include "src/world.h"
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+namespace {
+
+/**
+ * Boxes and balls thrown around in all directions inside a walled area,
+ * with speculative contacts on
+ */
+std::vector<Vec2> run_scene(BroadPhaseType broad_phase) {
+    World world(-9.8f);
+    world.set_broad_phase(broad_phase);
+    world.set_speculative_contacts(true);
+    world.create_body(BoxShape(1600, 50), 800, 1025, 0.0f);
+    world.create_body(BoxShape(50, 1000), -25, 500, 0.0f);
+    world.create_body(BoxShape(50, 1000), 1625, 500, 0.0f);
+
+    std::mt19937 random(7);
+    auto uniform = [&](float min, float max) {
+        return std::uniform_real_distribution<float>(min, max)(random);
+    };
+    for (int i = 0; i < 300; i++) {
+        const float x = uniform(50.0f, 1550.0f);
+        const float y = uniform(50.0f, 950.0f);
+        Body *body =
+            i % 3 == 0
+                ? world.get_body(world.create_body(
+                      CircleShape(uniform(5.0f, 20.0f)), x, y, 1.0f))
+                : world.get_body(world.create_body(
+                      BoxShape(uniform(10.0f, 40.0f), uniform(10.0f, 40.0f)),
+                      x, y, 1.0f));
+        body->velocity =
+            Vec2(uniform(-600.0f, 600.0f), uniform(-600.0f, 600.0f));
+    }
+
+    for (int step = 0; step < 120; step++) {
+        world.update(1.0f / 60.0f);
+    }
+
+    std::vector<Vec2> positions;
+    for (auto body : world.get_bodies()) {
+        positions.push_back(body->position);
+    }
+    return positions;
+}
+
+// the swept bounds decide which pairs are tested, not the broad phase, so
+// every broad phase makes the same speculative contacts
+TEST(SpeculativeContactTest, SameResultWithEveryBroadPhase) {
+    const std::vector<Vec2> expected = run_scene(BRUTE_FORCE);
+    for (auto broad_phase : {UNIFORM_GRID, DYNAMIC_TREE, SWEEP_AND_PRUNE}) {
+        const std::vector<Vec2> positions = run_scene(broad_phase);
+        ASSERT_EQ(positions.size(), expected.size());
+        for (size_t i = 0; i < positions.size(); i++) {
+            EXPECT_EQ(positions[i].x, expected[i].x)
+                << "broad phase " << broad_phase << ", body " << i;
+            EXPECT_EQ(positions[i].y, expected[i].y)
+                << "broad phase " << broad_phase << ", body " << i;
+        }
+    }
+}
+
+// two boxes flying apart are within reach of each other, but their gap only
+// grows, so they get no contact
+TEST(SpeculativeContactTest, SeparatingBodiesGetNoContact) {
+    World world(0.0f);
+    world.set_speculative_contacts(true);
+    Body *a = world.get_body(world.create_body(BoxShape(40, 40), 0, 0, 1.0f));
+    Body *b = world.get_body(world.create_body(BoxShape(40, 40), 45, 0, 1.0f));
+    a->velocity = Vec2(-600, 0);
+    b->velocity = Vec2(600, 0);
+
+    int num_contacts = 0;
+    world.set_debug_draw_contact([&](const Contact &) { num_contacts++; });
+    world.update(1.0f / 60.0f);
+    EXPECT_EQ(num_contacts, 0);
+}
+
+// the same boxes flying at each other get a contact before they touch
+TEST(SpeculativeContactTest, ClosingBodiesGetContact) {
+    World world(0.0f);
+    world.set_speculative_contacts(true);
+    Body *a = world.get_body(world.create_body(BoxShape(40, 40), 0, 0, 1.0f));
+    Body *b = world.get_body(world.create_body(BoxShape(40, 40), 45, 0, 1.0f));
+    a->velocity = Vec2(600, 0);
+    b->velocity = Vec2(-600, 0);
+
+    int num_contacts = 0;
+    world.set_debug_draw_contact([&](const Contact &) { num_contacts++; });
+    world.update(1.0f / 60.0f);
+    EXPECT_GT(num_contacts, 0);
+    EXPECT_LT(a->position.x, b->position.x);
+}
+
+} // namespace
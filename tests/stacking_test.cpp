@@ -0,0 +1,100 @@
+#include "src/body.h"
+#include "src/shape.h"
+#include "src/world.h"
+#include <cmath>
+#include <gtest/gtest.h>
+#include <tuple>
+
+namespace {
+
+const float FLOOR_TOP = 575.0f;
+
+/**
+ * Boxes stacked exactly on top of each other on a static floor, with the
+ * default friction and restitution
+ */
+class Tower {
+  public:
+    World world{-9.8f};
+    Body *top = nullptr;
+    float size;
+    int count;
+
+    Tower(int count, float size, int iterations) : size(size), count(count) {
+        world.set_iterations(iterations);
+        world.create_body(BoxShape(800, 50), 400, FLOOR_TOP + 25, 0.0f);
+        for (int i = 0; i < count; i++) {
+            const float y = FLOOR_TOP - size / 2 - i * size;
+            top = world.get_body(
+                world.create_body(BoxShape(size, size), 400, y, 1.0f));
+        }
+    }
+
+    // steps until every box is asleep, -1 if they never all fall asleep
+    int steps_to_sleep(int max_steps) {
+        for (int step = 1; step <= max_steps; step++) {
+            world.update(1.0f / 60.0f);
+            if (all_asleep()) {
+                return step;
+            }
+        }
+        return -1;
+    }
+
+    bool all_asleep() {
+        for (auto body : world.get_bodies()) {
+            if (!body->is_static() && body->is_awake) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // the top box is still on top, not sunk, bounced off or slid aside
+    void expect_standing() const {
+        const float rest_y = FLOOR_TOP - size / 2 - (count - 1) * size;
+        EXPECT_NEAR(top->position.y, rest_y, 0.2f * size);
+        EXPECT_NEAR(top->position.x, 400.0f, 0.05f * size);
+        EXPECT_NEAR(top->rotation, 0.0f, 0.05f);
+    }
+};
+
+class WarmStartTest
+    : public ::testing::TestWithParam<std::tuple<float, int>> {};
+
+// warm starting carries the impulses of a resting stack from one step to
+// the next, so a few iterations are enough to hold it up
+TEST_P(WarmStartTest, SmallStackSleepsAtLowIterations) {
+    const auto [size, iterations] = GetParam();
+    Tower tower(5, size, iterations);
+    EXPECT_GT(tower.steps_to_sleep(600), 0);
+    tower.expect_standing();
+}
+
+INSTANTIATE_TEST_SUITE_P(Stacking, WarmStartTest,
+                         ::testing::Combine(::testing::Values(40.0f, 50.0f),
+                                            ::testing::Values(2, 3)));
+
+class BlockSolverTest
+    : public ::testing::TestWithParam<std::tuple<float, int, int>> {};
+
+// solving both contacts of each box face together settles towers that the
+// one contact at a time solver topples at the same iteration count
+TEST_P(BlockSolverTest, TowerSleepsStanding) {
+    const auto [size, count, iterations] = GetParam();
+    Tower tower(count, size, iterations);
+    EXPECT_GT(tower.steps_to_sleep(600), 0);
+    tower.expect_standing();
+}
+
+// (box size, boxes, iterations)
+INSTANTIATE_TEST_SUITE_P(
+    Stacking, BlockSolverTest,
+    ::testing::Values(std::make_tuple(40.0f, 10, 4),
+                      std::make_tuple(50.0f, 10, 4),
+                      std::make_tuple(40.0f, 15, 8),
+                      std::make_tuple(50.0f, 15, 8),
+                      std::make_tuple(40.0f, 20, 16),
+                      std::make_tuple(50.0f, 20, 16)));
+
+} // namespace
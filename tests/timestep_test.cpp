@@ -0,0 +1,52 @@
+#include "src/body.h"
+#include "src/shape.h"
+#include "src/world.h"
+#include <cmath>
+#include <gtest/gtest.h>
+#include <limits>
+
+namespace {
+
+class TimestepTest : public ::testing::TestWithParam<float> {};
+
+// a timestep that can't advance the world is clamped instead of turning the
+// accumulator into NaN or looping forever
+TEST_P(TimestepTest, InvalidTimestepStillSteps) {
+    World world(-9.8f);
+    world.create_body(CircleShape(10), 0, 0, 1.0f);
+    world.set_fixed_timestep(GetParam());
+    world.set_max_steps(4);
+
+    EXPECT_EQ(world.step(1.0f), 4);
+    EXPECT_FALSE(std::isnan(world.get_alpha()));
+    EXPECT_FALSE(std::isnan(world.get_bodies()[0]->position.y));
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Stepping, TimestepTest,
+    ::testing::Values(0.0f, -1.0f / 60.0f,
+                      std::numeric_limits<float>::quiet_NaN()));
+
+TEST(TimestepTest, NegativeElapsedTimeIsIgnored) {
+    World world(-9.8f);
+    world.step(-1.0f);
+    EXPECT_EQ(world.step(1.0f / 60.0f), 1);
+    EXPECT_FALSE(std::isnan(world.get_alpha()));
+}
+
+class MaxStepsTest : public ::testing::TestWithParam<int> {};
+
+// no or a negative number of steps per call is clamped to one, so time
+// still passes
+TEST_P(MaxStepsTest, InvalidMaxStepsStillSteps) {
+    World world(-9.8f);
+    Body *body = world.get_body(world.create_body(CircleShape(10), 0, 0, 1.0f));
+    world.set_max_steps(GetParam());
+
+    EXPECT_EQ(world.step(1.0f / 60.0f), 1);
+    EXPECT_NE(body->position.y, 0.0f);
+}
+
+INSTANTIATE_TEST_SUITE_P(Stepping, MaxStepsTest, ::testing::Values(0, -3));
+
+} // namespace
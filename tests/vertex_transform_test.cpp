@@ -0,0 +1,73 @@
+#include "src/aabb.h"
+#include "src/vec2.h"
+#include "src/vertex_transform.h"
+#include <cmath>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+namespace {
+
+bool same_bits(float lhs, float rhs) {
+    return std::memcmp(&lhs, &rhs, sizeof(float)) == 0;
+}
+
+// four polygons at a time give what they give one by one, for even and odd
+// vertex counts
+TEST(VertexTransformTest, PolygonsMatchOneByOne) {
+    std::mt19937 random(7);
+    std::uniform_real_distribution<float> coordinate(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> angle(-4.0f, 4.0f);
+
+    for (int count = 1; count <= 8; count++) {
+        std::vector<Vec2> local(4 * count);
+        std::vector<float> local_x(4 * count);
+        std::vector<float> local_y(4 * count);
+        for (int l = 0; l < 4; l++) {
+            for (int k = 0; k < count; k++) {
+                local[l * count + k] =
+                    Vec2(coordinate(random), coordinate(random));
+                local_x[4 * k + l] = local[l * count + k].x;
+                local_y[4 * k + l] = local[l * count + k].y;
+            }
+        }
+        float cos_angle[4];
+        float sin_angle[4];
+        Vec2 position[4];
+        for (int l = 0; l < 4; l++) {
+            const float a = angle(random);
+            cos_angle[l] = std::cos(a);
+            sin_angle[l] = std::sin(a);
+            position[l] = Vec2(coordinate(random), coordinate(random));
+        }
+
+        std::vector<Vec2> world(4 * count);
+        Vec2 *world_of[4];
+        AABB bounds[4];
+        AABB *bounds_of[4];
+        for (int l = 0; l < 4; l++) {
+            world_of[l] = &world[l * count];
+            bounds_of[l] = &bounds[l];
+        }
+        transform_polygons(local_x.data(), local_y.data(), count, cos_angle,
+                           sin_angle, position, world_of, bounds_of);
+
+        for (int l = 0; l < 4; l++) {
+            std::vector<Vec2> expected(count);
+            const AABB expected_bounds =
+                transform_vertices(&local[l * count], expected.data(), count,
+                                   cos_angle[l], sin_angle[l], position[l]);
+            for (int k = 0; k < count; k++) {
+                EXPECT_TRUE(same_bits(world_of[l][k].x, expected[k].x));
+                EXPECT_TRUE(same_bits(world_of[l][k].y, expected[k].y));
+            }
+            EXPECT_TRUE(same_bits(bounds[l].min.x, expected_bounds.min.x));
+            EXPECT_TRUE(same_bits(bounds[l].min.y, expected_bounds.min.y));
+            EXPECT_TRUE(same_bits(bounds[l].max.x, expected_bounds.max.x));
+            EXPECT_TRUE(same_bits(bounds[l].max.y, expected_bounds.max.y));
+        }
+    }
+}
+
+} // namespace